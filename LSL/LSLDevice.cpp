@@ -9,9 +9,47 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 namespace Protocols
 {
 
+static lsl_protocol::lsl_inlet_options
+inletOptions(const LSLSpecificSettings& settings, const std::string& uid)
+{
+  lsl_protocol::lsl_inlet_options options;
+  auto it = std::find_if(
+      settings.inletConfigs.begin(), settings.inletConfigs.end(),
+      [&](const LSLInletConfig& c) { return c.uid == uid; });
+  if (it == settings.inletConfigs.end())
+    return options;
+
+  if (it->delivery == "every_frame")
+    options.delivery = lsl_protocol::lsl_delivery_policy::every_frame;
+  else if (it->delivery == "batch")
+    options.delivery = lsl_protocol::lsl_delivery_policy::batch;
+  options.frame_mode = it->frameMode;
+
+  if (it->buffering == "low_latency")
+  {
+    options.buffering = lsl_protocol::lsl_buffer_options::low_latency();
+  }
+  else if (it->buffering == "low_memory")
+  {
+    options.buffering = lsl_protocol::lsl_buffer_options::low_memory();
+  }
+  else if (it->buffering == "custom")
+  {
+    options.buffering.max_buflen = it->maxBuflen;
+    options.buffering.max_chunklen = it->maxChunklen;
+    options.buffering.recover = it->recover;
+    options.buffering.postprocessing = (it->clockSync ? lsl::post_clocksync : 0)
+                                       | (it->dejitter ? lsl::post_dejitter : 0)
+                                       | (it->monotonize ? lsl::post_monotonize : 0);
+  }
+  return options;
+}
+
 LSLDevice::LSLDevice(const Device::DeviceSettings& settings)
     : OwningDeviceInterface{settings}
 {
@@ -42,10 +80,19 @@ bool LSLDevice::reconnect()
     auto protocol = std::make_unique<lsl_protocol::lsl_protocol>(context);
 
     // Configure the protocol
-    if(!lsl_settings.streamTypeFilter.empty())
-    {
-      protocol->set_stream_type_filter(lsl_settings.streamTypeFilter);
-    }
+    lsl_protocol::lsl_stream_filter filter;
+    filter.type = lsl_settings.streamTypeFilter;
+    filter.name = lsl_settings.nameFilter;
+    filter.hostname = lsl_settings.hostFilter;
+    filter.source_id = lsl_settings.sourceIdFilter;
+    protocol->set_stream_filter(filter);
+    protocol->set_worker_count(lsl_settings.inletThreads);
+
+    lsl_protocol::lsl_alignment_options alignment;
+    alignment.streams = lsl_settings.alignedStreams;
+    alignment.rate = lsl_settings.alignmentRate;
+    alignment.delay = lsl_settings.alignmentDelay / 1000.;
+    protocol->set_alignment(alignment);
 
     // Create ossia device
     m_dev = std::make_unique<ossia::net::generic_device>(
@@ -61,11 +108,38 @@ bool LSLDevice::reconnect()
       lsl::channel_format_t format = lsl::cf_float32;
       ossia::val_type ossia_type = ossia::val_type::FLOAT;
       
-      if (sensorConfig.dataType == "int")
+      if (sensorConfig.dataType == "double")
+      {
+        format = lsl::cf_double64;
+      }
+      else if (sensorConfig.dataType == "int")
       {
         format = lsl::cf_int32;
         ossia_type = ossia::val_type::INT;
       }
+      else if (sensorConfig.dataType == "int8")
+      {
+        format = lsl::cf_int8;
+        ossia_type = ossia::val_type::INT;
+      }
+      else if (sensorConfig.dataType == "int16")
+      {
+        format = lsl::cf_int16;
+        ossia_type = ossia::val_type::INT;
+      }
+      else if (sensorConfig.dataType == "int64")
+      {
+        format = lsl::cf_int64;
+        ossia_type = ossia::val_type::INT;
+      }
+      else if (sensorConfig.dataType == "quantized_int8")
+      {
+        format = lsl::cf_int8;
+      }
+      else if (sensorConfig.dataType == "quantized_int16")
+      {
+        format = lsl::cf_int16;
+      }
       else if (sensorConfig.dataType == "string")
       {
         format = lsl::cf_string;
@@ -81,6 +155,15 @@ bool LSLDevice::reconnect()
           format,
           sensorConfig.sourceId.toStdString());
 
+      // An inverted range is swapped; an empty one cannot be quantised and is
+      // left to the default of the outlet
+      const auto [rangeMin, rangeMax]
+          = std::minmax(sensorConfig.rangeMin, sensorConfig.rangeMax);
+      const bool quantized = sensorConfig.dataType.startsWith("quantized_");
+      if (quantized && rangeMin == rangeMax)
+        qWarning() << "LSL outlet" << sensorConfig.streamName
+                   << ": empty range, quantizing [-1, 1] instead";
+
       // Convert channel info
       std::vector<lsl_protocol::lsl_channel_info> channelInfo;
       for (const auto& channelName : sensorConfig.channelNames)
@@ -89,21 +172,31 @@ bool LSLDevice::reconnect()
         info.name = channelName;
         info.lsl_format = format;
         info.ossia_type = ossia_type;
+        if (quantized && rangeMin < rangeMax)
+          info.domain = ossia::make_domain(
+              static_cast<float>(rangeMin), static_cast<float>(rangeMax));
         channelInfo.push_back(info);
       }
 
+      lsl_protocol::lsl_outlet_options options;
+      options.coalesce_window = std::chrono::microseconds(
+          static_cast<int64_t>(sensorConfig.coalesceWindow * 1000.));
+      options.quantize = quantized;
+
       // Create the outlet
-      lsl_proto->create_outlet(streamInfo, channelInfo);
+      lsl_proto->create_outlet(streamInfo, channelInfo, options);
     }
 
     // Start discovery
     lsl_proto->start_discovery();
 
-    // Subscribe to configured streams
+    // Subscribe to configured streams, all at once
+    std::vector<lsl_protocol::lsl_protocol::stream_subscription> subscriptions;
     for (const auto& uid : lsl_settings.subscribedStreams)
     {
-      lsl_proto->subscribe_to_stream(uid);
+      subscriptions.emplace_back(uid, inletOptions(lsl_settings, uid));
     }
+    lsl_proto->subscribe_to_streams(subscriptions);
 
     deviceChanged(nullptr, m_dev.get());
     return true;
@@ -8,15 +8,17 @@
 #include <QCheckBox>
 #include <QComboBox>
 #include <QDebug>
+#include <QDialog>
+#include <QDialogButtonBox>
 #include <QDoubleSpinBox>
 #include <QFormLayout>
 #include <QHBoxLayout>
+#include <QHash>
 #include <QHeaderView>
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QSpinBox>
-#include <QTimer>
 #include <QTreeWidget>
 #include <QVBoxLayout>
 
@@ -44,6 +46,35 @@ LSLProtocolSettingsWidget::LSLProtocolSettingsWidget(QWidget* parent)
   m_streamTypeFilter = new QLineEdit;
   m_streamTypeFilter->setPlaceholderText(tr("Leave empty for all types"));
   settingsForm->addRow(tr("Stream Types:"), m_streamTypeFilter);
+
+  m_nameFilter = new QLineEdit;
+  m_nameFilter->setPlaceholderText(tr("Leave empty for all names, * as wildcard"));
+  settingsForm->addRow(tr("Stream Names:"), m_nameFilter);
+
+  m_hostFilter = new QLineEdit;
+  m_hostFilter->setPlaceholderText(tr("Leave empty for all hosts"));
+  settingsForm->addRow(tr("Hosts:"), m_hostFilter);
+
+  m_sourceIdFilter = new QLineEdit;
+  m_sourceIdFilter->setPlaceholderText(tr("Leave empty for all source IDs"));
+  settingsForm->addRow(tr("Source IDs:"), m_sourceIdFilter);
+
+  m_inletThreads = new QSpinBox;
+  m_inletThreads->setRange(0, 64);
+  m_inletThreads->setSpecialValueText(tr("Automatic"));
+  settingsForm->addRow(tr("Inlet Threads:"), m_inletThreads);
+
+  m_alignmentRate = new QDoubleSpinBox;
+  m_alignmentRate->setRange(0., 1000.);
+  m_alignmentRate->setSuffix(tr(" Hz"));
+  m_alignmentRate->setSpecialValueText(tr("Disabled"));
+  settingsForm->addRow(tr("Alignment Rate:"), m_alignmentRate);
+
+  m_alignmentDelay = new QDoubleSpinBox;
+  m_alignmentDelay->setRange(0., 5000.);
+  m_alignmentDelay->setSuffix(tr(" ms"));
+  m_alignmentDelay->setValue(100.);
+  settingsForm->addRow(tr("Alignment Delay:"), m_alignmentDelay);
   
   mainLayout->addLayout(settingsForm);
 
@@ -55,8 +86,11 @@ LSLProtocolSettingsWidget::LSLProtocolSettingsWidget(QWidget* parent)
   inboundLayout->addWidget(new QLabel(tr("Inbound Streams")));
   
   m_inboundTree = new QTreeWidget;
-  m_inboundTree->setHeaderLabels({tr("Stream"), tr("Type"), tr("Channels"), tr("Rate"), tr("UID")});
+  m_inboundTree->setHeaderLabels(
+      {tr("Stream"), tr("Type"), tr("Channels"), tr("Rate"), tr("UID"), tr("Delivery"),
+       tr("Frame"), tr("Align"), tr("Buffering")});
   m_inboundTree->setSelectionMode(QAbstractItemView::MultiSelection);
+  connect(m_inboundTree, &QTreeWidget::itemDoubleClicked, this, &LSLProtocolSettingsWidget::on_inboundItemDoubleClicked);
   inboundLayout->addWidget(m_inboundTree);
   
   treeLayout->addLayout(inboundLayout, 1);
@@ -66,7 +100,8 @@ LSLProtocolSettingsWidget::LSLProtocolSettingsWidget(QWidget* parent)
   outboundLayout->addWidget(new QLabel(tr("Outbound Sensors")));
   
   m_outboundTree = new QTreeWidget;
-  m_outboundTree->setHeaderLabels({tr("Sensor Name"), tr("Data Type")});
+  m_outboundTree->setHeaderLabels(
+      {tr("Sensor Name"), tr("Data Type"), tr("Coalesce (ms)"), tr("Min"), tr("Max")});
   m_outboundTree->setSelectionMode(QAbstractItemView::SingleSelection);
   m_outboundTree->setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed);
   connect(m_outboundTree, &QTreeWidget::itemChanged, this, &LSLProtocolSettingsWidget::on_itemChanged);
@@ -102,22 +137,32 @@ LSLProtocolSettingsWidget::LSLProtocolSettingsWidget(QWidget* parent)
   // Update button states
   updateOutboundButtons();
 
+  // Get LSL context for discovery: the widget lists every stream on the network
+  static const auto context = ossia::unique_instance<lsl_protocol::lsl_context>();
+  context->acquire_discovery();
+
+  // Register callback for immediate updates: only what changed is applied.
+  // Registered before the tree is filled so that no change falls in between;
+  // the deltas queued meanwhile are applied after it, duplicates included.
+  m_streamCallback = context->register_stream_callback(
+      [self = QPointer{this}](const lsl_protocol::lsl_stream_delta& delta) {
+        if(self)
+          QMetaObject::invokeMethod(
+              self, [self, delta] {
+                if(self)
+                  self->applyStreamDelta(delta);
+              }, Qt::QueuedConnection);
+      });
+
   // Populate inbound tree
   populateInboundTree();
-  
-  // Get LSL context for discovery
+}
+
+LSLProtocolSettingsWidget::~LSLProtocolSettingsWidget()
+{
   static const auto context = ossia::unique_instance<lsl_protocol::lsl_context>();
-  // Set up timer for periodic updates
-  auto* timer = new QTimer(this);
-  connect(timer, &QTimer::timeout, this, &LSLProtocolSettingsWidget::populateInboundTree);
-  timer->start(2000);
-  
-  // Register callback for immediate updates
-  context->register_stream_callback([self = QPointer{this}]() {
-    if(self)
-      QMetaObject::invokeMethod(
-          self, &LSLProtocolSettingsWidget::populateInboundTree, Qt::QueuedConnection);
-  });
+  context->unregister_stream_callback(m_streamCallback);
+  context->release_discovery();
 }
 
 Device::DeviceSettings LSLProtocolSettingsWidget::getSettings() const
@@ -128,9 +173,17 @@ Device::DeviceSettings LSLProtocolSettingsWidget::getSettings() const
   // Update specific settings
   LSLSpecificSettings lsl_settings = m_settings;
   lsl_settings.streamTypeFilter = m_streamTypeFilter->text().toStdString();
+  lsl_settings.nameFilter = m_nameFilter->text().toStdString();
+  lsl_settings.hostFilter = m_hostFilter->text().toStdString();
+  lsl_settings.sourceIdFilter = m_sourceIdFilter->text().toStdString();
+  lsl_settings.inletThreads = m_inletThreads->value();
+  lsl_settings.alignmentRate = m_alignmentRate->value();
+  lsl_settings.alignmentDelay = m_alignmentDelay->value();
 
   // Get selected streams
   lsl_settings.subscribedStreams.clear();
+  lsl_settings.inletConfigs.clear();
+  lsl_settings.alignedStreams.clear();
   for (int i = 0; i < m_inboundTree->topLevelItemCount(); ++i)
   {
     auto* item = m_inboundTree->topLevelItem(i);
@@ -138,6 +191,16 @@ Device::DeviceSettings LSLProtocolSettingsWidget::getSettings() const
     {
       QString uid = item->text(4);
       lsl_settings.subscribedStreams.push_back(uid.toStdString());
+
+      LSLInletConfig config = m_customBuffering.value(uid);
+      config.uid = uid.toStdString();
+      config.delivery = item->text(5);
+      config.buffering = item->text(8);
+      config.frameMode = item->checkState(6) == Qt::Checked;
+      lsl_settings.inletConfigs.push_back(config);
+
+      if (item->checkState(7) == Qt::Checked)
+        lsl_settings.alignedStreams.push_back(uid.toStdString());
     }
   }
   
@@ -149,6 +212,18 @@ Device::DeviceSettings LSLProtocolSettingsWidget::getSettings() const
     LSLSensorConfig sensor;
     sensor.streamName = sensorItem->text(0);
     sensor.dataType = sensorItem->text(1);
+    sensor.coalesceWindow = sensorItem->text(2).toDouble();
+
+    // Text that is not a number keeps the default bound, an inverted range is swapped
+    bool minOk{}, maxOk{};
+    const double rangeMin = sensorItem->text(3).toDouble(&minOk);
+    const double rangeMax = sensorItem->text(4).toDouble(&maxOk);
+    if (minOk)
+      sensor.rangeMin = rangeMin;
+    if (maxOk)
+      sensor.rangeMax = rangeMax;
+    if (sensor.rangeMin > sensor.rangeMax)
+      std::swap(sensor.rangeMin, sensor.rangeMax);
     
     // Get channel names from children
     for (int j = 0; j < sensorItem->childCount(); ++j)
@@ -172,6 +247,16 @@ void LSLProtocolSettingsWidget::setSettings(const Device::DeviceSettings& settin
   {
     m_settings = settings.deviceSpecificSettings.value<LSLSpecificSettings>();
     m_streamTypeFilter->setText(QString::fromStdString(m_settings.streamTypeFilter));
+    m_nameFilter->setText(QString::fromStdString(m_settings.nameFilter));
+    m_hostFilter->setText(QString::fromStdString(m_settings.hostFilter));
+    m_sourceIdFilter->setText(QString::fromStdString(m_settings.sourceIdFilter));
+    m_inletThreads->setValue(m_settings.inletThreads);
+    m_alignmentRate->setValue(m_settings.alignmentRate);
+    m_alignmentDelay->setValue(m_settings.alignmentDelay);
+
+    m_customBuffering.clear();
+    for (const auto& config : m_settings.inletConfigs)
+      m_customBuffering[QString::fromStdString(config.uid)] = config;
 
     populateInboundTree();
     populateOutboundTree();
@@ -180,8 +265,20 @@ void LSLProtocolSettingsWidget::setSettings(const Device::DeviceSettings& settin
 
 void LSLProtocolSettingsWidget::populateInboundTree()
 {
-  // Save selected UIDs
+  // Save selected UIDs and per-stream options
   QStringList selectedUids;
+  QHash<QString, QString> deliveries;
+  QHash<QString, bool> frameModes;
+  QHash<QString, bool> aligned;
+  QHash<QString, QString> bufferings;
+  for (const auto& uid : m_settings.alignedStreams)
+    aligned[QString::fromStdString(uid)] = true;
+  for (const auto& config : m_settings.inletConfigs)
+  {
+    deliveries[QString::fromStdString(config.uid)] = config.delivery;
+    frameModes[QString::fromStdString(config.uid)] = config.frameMode;
+    bufferings[QString::fromStdString(config.uid)] = config.buffering;
+  }
   for (int i = 0; i < m_inboundTree->topLevelItemCount(); ++i)
   {
     auto* item = m_inboundTree->topLevelItem(i);
@@ -189,6 +286,10 @@ void LSLProtocolSettingsWidget::populateInboundTree()
     {
       selectedUids.append(item->text(4));
     }
+    deliveries[item->text(4)] = item->text(5);
+    frameModes[item->text(4)] = item->checkState(6) == Qt::Checked;
+    aligned[item->text(4)] = item->checkState(7) == Qt::Checked;
+    bufferings[item->text(4)] = item->text(8);
   }
   
   m_inboundTree->clear();
@@ -197,14 +298,16 @@ void LSLProtocolSettingsWidget::populateInboundTree()
   static const auto context = ossia::unique_instance<lsl_protocol::lsl_context>();
   auto streams = context->get_current_streams();
 
-  for(const auto& [uid, stream] : streams)
+  for(const auto& [uid, stream] : *streams)
   {
     auto* item = new QTreeWidgetItem;
-    item->setText(0, QString::fromStdString(stream.name));
-    item->setText(1, QString::fromStdString(stream.type));
-    item->setText(2, QString::number(stream.channel_count));
-    item->setText(3, QString::number(stream.nominal_srate));
-    item->setText(4, QString::fromStdString(uid));
+    setInboundItemStream(item, stream);
+    item->setText(5, deliveries.value(QString::fromStdString(uid), "latest"));
+    item->setCheckState(
+        6, frameModes.value(QString::fromStdString(uid)) ? Qt::Checked : Qt::Unchecked);
+    item->setCheckState(
+        7, aligned.value(QString::fromStdString(uid)) ? Qt::Checked : Qt::Unchecked);
+    item->setText(8, bufferings.value(QString::fromStdString(uid), "default"));
 
     item->setCheckState(
         0,
@@ -220,6 +323,76 @@ void LSLProtocolSettingsWidget::populateInboundTree()
   m_inboundTree->resizeColumnToContents(1);
 }
 
+QTreeWidgetItem* LSLProtocolSettingsWidget::findInboundItem(const QString& uid) const
+{
+  for (int i = 0; i < m_inboundTree->topLevelItemCount(); ++i)
+  {
+    auto* item = m_inboundTree->topLevelItem(i);
+    if (item->text(4) == uid)
+      return item;
+  }
+  return nullptr;
+}
+
+void LSLProtocolSettingsWidget::setInboundItemStream(
+    QTreeWidgetItem* item, const lsl_protocol::lsl_stream_data& stream)
+{
+  item->setText(0, QString::fromStdString(stream.name));
+  item->setText(1, QString::fromStdString(stream.type));
+  item->setText(2, QString::number(stream.channel_count));
+  item->setText(3, QString::number(stream.nominal_srate));
+  item->setText(4, QString::fromStdString(stream.uid));
+}
+
+void LSLProtocolSettingsWidget::applyStreamDelta(const lsl_protocol::lsl_stream_delta& delta)
+{
+  for (const auto& uid : delta.removed)
+  {
+    delete findInboundItem(QString::fromStdString(uid));
+  }
+
+  for (const auto& stream : delta.changed)
+  {
+    if (auto* item = findInboundItem(QString::fromStdString(stream.uid)))
+      setInboundItemStream(item, stream);
+  }
+
+  for (const auto& stream : delta.added)
+  {
+    // May already be there if it was part of the initial population
+    const auto uid = QString::fromStdString(stream.uid);
+    if (auto* item = findInboundItem(uid))
+    {
+      setInboundItemStream(item, stream);
+      continue;
+    }
+
+    auto* item = new QTreeWidgetItem;
+    setInboundItemStream(item, stream);
+
+    // New streams take their options from the settings
+    item->setText(5, "latest");
+    item->setCheckState(6, Qt::Unchecked);
+    item->setText(8, "default");
+    for (const auto& config : m_settings.inletConfigs)
+    {
+      if (config.uid == stream.uid)
+      {
+        item->setText(5, config.delivery);
+        item->setCheckState(6, config.frameMode ? Qt::Checked : Qt::Unchecked);
+        item->setText(8, config.buffering);
+      }
+    }
+    item->setCheckState(
+        7, ossia::contains(m_settings.alignedStreams, stream.uid) ? Qt::Checked
+                                                                  : Qt::Unchecked);
+    item->setCheckState(
+        0, ossia::contains(m_settings.subscribedStreams, stream.uid) ? Qt::Checked
+                                                                     : Qt::Unchecked);
+    m_inboundTree->addTopLevelItem(item);
+  }
+}
+
 void LSLProtocolSettingsWidget::populateOutboundTree()
 {
   m_outboundTree->clear();
@@ -229,6 +402,9 @@ void LSLProtocolSettingsWidget::populateOutboundTree()
     auto* sensorItem = new QTreeWidgetItem;
     sensorItem->setText(0, sensor.streamName);
     sensorItem->setText(1, sensor.dataType);
+    sensorItem->setText(2, QString::number(sensor.coalesceWindow));
+    sensorItem->setText(3, QString::number(sensor.rangeMin));
+    sensorItem->setText(4, QString::number(sensor.rangeMax));
     sensorItem->setFlags(sensorItem->flags() | Qt::ItemIsEditable);
     sensorItem->setExpanded(true);
     
@@ -253,6 +429,9 @@ void LSLProtocolSettingsWidget::on_addSensor()
   auto* sensorItem = new QTreeWidgetItem;
   sensorItem->setText(0, tr("NewSensor"));
   sensorItem->setText(1, "float");
+  sensorItem->setText(2, "0");
+  sensorItem->setText(3, "-1");
+  sensorItem->setText(4, "1");
   sensorItem->setFlags(sensorItem->flags() | Qt::ItemIsEditable);
   sensorItem->setExpanded(true);
   
@@ -316,7 +495,9 @@ void LSLProtocolSettingsWidget::on_itemDoubleClicked(QTreeWidgetItem* item, int
   {
     // Create combo box for data type selection
     auto* combo = new QComboBox;
-    combo->addItems({"float", "int", "string"});
+    combo->addItems(
+        {"float", "double", "int8", "int16", "int", "int64", "string", "quantized_int8",
+         "quantized_int16"});
     combo->setCurrentText(item->text(1));
     
     connect(combo, QOverload<const QString&>::of(&QComboBox::currentTextChanged),
@@ -329,6 +510,101 @@ void LSLProtocolSettingsWidget::on_itemDoubleClicked(QTreeWidgetItem* item, int
   }
 }
 
+void LSLProtocolSettingsWidget::on_inboundItemDoubleClicked(QTreeWidgetItem* item, int column)
+{
+  if (column == 5) // Delivery policy column
+  {
+    auto* combo = new QComboBox;
+    combo->addItems({"latest", "every_frame", "batch"});
+    combo->setCurrentText(item->text(5));
+
+    connect(combo, QOverload<const QString&>::of(&QComboBox::currentTextChanged),
+            [item](const QString& text) {
+              item->setText(5, text);
+            });
+
+    m_inboundTree->setItemWidget(item, 5, combo);
+    combo->showPopup();
+  }
+  else if (column == 8) // Buffering preset column
+  {
+    auto* combo = new QComboBox;
+    combo->addItems({"default", "low_latency", "low_memory", "custom"});
+    combo->setCurrentText(item->text(8));
+
+    // Choosing "custom", even again, opens the editor of its values
+    connect(combo, QOverload<int>::of(&QComboBox::activated),
+            [this, item, combo](int) {
+              const QString text = combo->currentText();
+              if (text != "custom")
+                item->setText(8, text);
+              else if (editCustomBuffering(item))
+                item->setText(8, text);
+              else
+                combo->setCurrentText(item->text(8));
+            });
+
+    m_inboundTree->setItemWidget(item, 8, combo);
+    combo->showPopup();
+  }
+}
+
+bool LSLProtocolSettingsWidget::editCustomBuffering(QTreeWidgetItem* item)
+{
+  const QString uid = item->text(4);
+  LSLInletConfig config = m_customBuffering.value(uid);
+
+  QDialog dialog(this);
+  dialog.setWindowTitle(tr("Buffering of %1").arg(item->text(0)));
+  auto form = new QFormLayout(&dialog);
+
+  auto maxBuflen = new QSpinBox;
+  maxBuflen->setRange(1, 3600);
+  maxBuflen->setValue(config.maxBuflen);
+  maxBuflen->setSuffix(tr(" s"));
+  maxBuflen->setToolTip(tr("Hundreds of samples for irregular streams"));
+  form->addRow(tr("Max Buffer:"), maxBuflen);
+
+  auto maxChunklen = new QSpinBox;
+  maxChunklen->setRange(0, 65536);
+  maxChunklen->setValue(config.maxChunklen);
+  maxChunklen->setSpecialValueText(tr("Outlet default"));
+  form->addRow(tr("Max Chunk:"), maxChunklen);
+
+  auto recover = new QCheckBox;
+  recover->setChecked(config.recover);
+  form->addRow(tr("Recover:"), recover);
+
+  auto clockSync = new QCheckBox;
+  clockSync->setChecked(config.clockSync);
+  form->addRow(tr("Clock Sync:"), clockSync);
+
+  auto dejitter = new QCheckBox;
+  dejitter->setChecked(config.dejitter);
+  form->addRow(tr("Dejitter:"), dejitter);
+
+  auto monotonize = new QCheckBox;
+  monotonize->setChecked(config.monotonize);
+  form->addRow(tr("Monotonize:"), monotonize);
+
+  auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+  connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+  connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+  form->addRow(buttons);
+
+  if (dialog.exec() != QDialog::Accepted)
+    return false;
+
+  config.maxBuflen = maxBuflen->value();
+  config.maxChunklen = maxChunklen->value();
+  config.recover = recover->isChecked();
+  config.clockSync = clockSync->isChecked();
+  config.dejitter = dejitter->isChecked();
+  config.monotonize = monotonize->isChecked();
+  m_customBuffering[uid] = config;
+  return true;
+}
+
 void LSLProtocolSettingsWidget::updateOutboundButtons()
 {
   auto* current = m_outboundTree->currentItem();
@@ -2,6 +2,8 @@
 #include <Device/Protocol/ProtocolSettingsWidget.hpp>
 #include "LSLSpecificSettings.hpp"
 
+#include <QHash>
+
 class QLineEdit;
 class QTreeWidget;
 class QTreeWidgetItem;
@@ -10,6 +12,12 @@ class QSpinBox;
 class QDoubleSpinBox;
 class QComboBox;
 
+namespace lsl_protocol
+{
+struct lsl_stream_data;
+struct lsl_stream_delta;
+}
+
 namespace Protocols
 {
 
@@ -17,6 +25,7 @@ class LSLProtocolSettingsWidget final : public Device::ProtocolSettingsWidget
 {
 public:
   explicit LSLProtocolSettingsWidget(QWidget* parent = nullptr);
+  ~LSLProtocolSettingsWidget() override;
 
   Device::DeviceSettings getSettings() const override;
   void setSettings(const Device::DeviceSettings& settings) override;
@@ -28,15 +37,26 @@ private:
   void on_removeChannel();
   void on_itemChanged(QTreeWidgetItem* item, int column);
   void on_itemDoubleClicked(QTreeWidgetItem* item, int column);
+  void on_inboundItemDoubleClicked(QTreeWidgetItem* item, int column);
+  bool editCustomBuffering(QTreeWidgetItem* item);
   void updateOutboundButtons();
 
 private:
   void populateInboundTree();
+  void applyStreamDelta(const lsl_protocol::lsl_stream_delta& delta);
+  QTreeWidgetItem* findInboundItem(const QString& uid) const;
+  void setInboundItemStream(QTreeWidgetItem* item, const lsl_protocol::lsl_stream_data& stream);
   void populateOutboundTree();
   
   // UI elements
   QLineEdit* m_name;
   QLineEdit* m_streamTypeFilter;
+  QLineEdit* m_nameFilter;
+  QLineEdit* m_hostFilter;
+  QLineEdit* m_sourceIdFilter;
+  QSpinBox* m_inletThreads;
+  QDoubleSpinBox* m_alignmentRate;
+  QDoubleSpinBox* m_alignmentDelay;
   QTreeWidget* m_inboundTree;
   QTreeWidget* m_outboundTree;
   
@@ -47,5 +67,11 @@ private:
   
   // Settings
   LSLSpecificSettings m_settings;
+
+  // Values of the "custom" buffering of the inbound streams, by UID
+  QHash<QString, LSLInletConfig> m_customBuffering;
+
+  // Discovery notifications
+  uint64_t m_streamCallback{};
 };
 }
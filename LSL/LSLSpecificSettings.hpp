@@ -14,15 +14,45 @@ struct LSLSensorConfig
   QString streamType{"Measurement"};
   QString sourceId{"ossia_score"};
   double sampleRate{100.0};
-  QString dataType{"float"}; // "float", "int", "string"
+  QString dataType{"float"}; // "float", "double", "int8", "int16", "int", "int64", "string",
+                             // "quantized_int8", "quantized_int16"
   std::vector<std::string> channelNames; // Simple list of channel names
+  double coalesceWindow{0.};             // ms; writes within the window make one sample
+  double rangeMin{-1.};                  // Range of the channels, mapped onto the
+  double rangeMax{1.};                   // integers by the quantized data types
+};
+
+// Per-stream configuration of a subscribed stream
+struct LSLInletConfig
+{
+  std::string uid;
+  QString delivery{"latest"}; // "latest", "every_frame", "batch"
+  bool frameMode{false};      // Single list / vecNf parameter per stream
+
+  // Inlet buffering: "default", "low_latency", "low_memory" presets,
+  // or "custom" to use the values below
+  QString buffering{"default"};
+  int maxBuflen{360};         // s (hundreds of samples for irregular streams)
+  int maxChunklen{0};         // Samples, 0 for the outlet's default
+  bool recover{true};
+  bool clockSync{false};      // LSL post-processing
+  bool dejitter{false};
+  bool monotonize{false};
 };
 
 struct LSLSpecificSettings
 {
   std::string streamTypeFilter;                 // Empty means all types
+  std::string nameFilter;                       // Empty means all names
+  std::string hostFilter;                       // Empty means all hosts
+  std::string sourceIdFilter;                   // Empty means all source IDs
   std::vector<std::string> subscribedStreams;   // UIDs of streams to subscribe to
   std::vector<LSLSensorConfig> outboundSensors; // Configured output sensors
+  std::vector<LSLInletConfig> inletConfigs;     // Options of subscribed streams, by UID
+  int inletThreads{0};                          // Inlet worker threads, 0 for automatic
+  std::vector<std::string> alignedStreams;      // UIDs of the streams resampled together
+  double alignmentRate{0.};                     // Aligned frames per second, 0 disables
+  double alignmentDelay{100.};                  // Alignment latency, in milliseconds
 };
 
 }
@@ -33,3 +63,6 @@ W_REGISTER_ARGTYPE(Protocols::LSLSpecificSettings)
 
 Q_DECLARE_METATYPE(Protocols::LSLSensorConfig)
 W_REGISTER_ARGTYPE(Protocols::LSLSensorConfig)
+
+Q_DECLARE_METATYPE(Protocols::LSLInletConfig)
+W_REGISTER_ARGTYPE(Protocols::LSLInletConfig)
@@ -8,14 +8,16 @@
 template <>
 void DataStreamReader::read(const Protocols::LSLSensorConfig& n)
 {
-  m_stream << n.streamName << n.streamType << n.sourceId << n.sampleRate << n.dataType << n.channelNames;
+  m_stream << n.streamName << n.streamType << n.sourceId << n.sampleRate << n.dataType << n.channelNames
+           << n.coalesceWindow << n.rangeMin << n.rangeMax;
   insertDelimiter();
 }
 
 template <>
 void DataStreamWriter::write(Protocols::LSLSensorConfig& n)
 {
-  m_stream >> n.streamName >> n.streamType >> n.sourceId >> n.sampleRate >> n.dataType >> n.channelNames;
+  m_stream >> n.streamName >> n.streamType >> n.sourceId >> n.sampleRate >> n.dataType >> n.channelNames
+      >> n.coalesceWindow >> n.rangeMin >> n.rangeMax;
   checkDelimiter();
 }
 
@@ -28,6 +30,9 @@ void JSONReader::read(const Protocols::LSLSensorConfig& n)
   obj["SampleRate"] = n.sampleRate;
   obj["DataType"] = n.dataType;
   obj["ChannelNames"] = n.channelNames;
+  obj["CoalesceWindow"] = n.coalesceWindow;
+  obj["RangeMin"] = n.rangeMin;
+  obj["RangeMax"] = n.rangeMax;
 }
 
 template <>
@@ -45,20 +50,87 @@ void JSONWriter::write(Protocols::LSLSensorConfig& n)
     n.dataType <<= *it;
   if (auto it = obj.tryGet("ChannelNames"))
     n.channelNames <<= *it;
+  if (auto it = obj.tryGet("CoalesceWindow"))
+    n.coalesceWindow <<= *it;
+  if (auto it = obj.tryGet("RangeMin"))
+    n.rangeMin <<= *it;
+  if (auto it = obj.tryGet("RangeMax"))
+    n.rangeMax <<= *it;
+}
+
+// Inlet config serialization
+template <>
+void DataStreamReader::read(const Protocols::LSLInletConfig& n)
+{
+  m_stream << n.uid << n.delivery << n.frameMode << n.buffering << n.maxBuflen
+           << n.maxChunklen << n.recover << n.clockSync << n.dejitter << n.monotonize;
+  insertDelimiter();
+}
+
+template <>
+void DataStreamWriter::write(Protocols::LSLInletConfig& n)
+{
+  m_stream >> n.uid >> n.delivery >> n.frameMode >> n.buffering >> n.maxBuflen
+      >> n.maxChunklen >> n.recover >> n.clockSync >> n.dejitter >> n.monotonize;
+  checkDelimiter();
+}
+
+template <>
+void JSONReader::read(const Protocols::LSLInletConfig& n)
+{
+  obj["UID"] = n.uid;
+  obj["Delivery"] = n.delivery;
+  obj["FrameMode"] = n.frameMode;
+  obj["Buffering"] = n.buffering;
+  obj["MaxBuflen"] = n.maxBuflen;
+  obj["MaxChunklen"] = n.maxChunklen;
+  obj["Recover"] = n.recover;
+  obj["ClockSync"] = n.clockSync;
+  obj["Dejitter"] = n.dejitter;
+  obj["Monotonize"] = n.monotonize;
+}
+
+template <>
+void JSONWriter::write(Protocols::LSLInletConfig& n)
+{
+  if (auto it = obj.tryGet("UID"))
+    n.uid <<= *it;
+  if (auto it = obj.tryGet("Delivery"))
+    n.delivery <<= *it;
+  if (auto it = obj.tryGet("FrameMode"))
+    n.frameMode <<= *it;
+  if (auto it = obj.tryGet("Buffering"))
+    n.buffering <<= *it;
+  if (auto it = obj.tryGet("MaxBuflen"))
+    n.maxBuflen <<= *it;
+  if (auto it = obj.tryGet("MaxChunklen"))
+    n.maxChunklen <<= *it;
+  if (auto it = obj.tryGet("Recover"))
+    n.recover <<= *it;
+  if (auto it = obj.tryGet("ClockSync"))
+    n.clockSync <<= *it;
+  if (auto it = obj.tryGet("Dejitter"))
+    n.dejitter <<= *it;
+  if (auto it = obj.tryGet("Monotonize"))
+    n.monotonize <<= *it;
 }
 
 // Main settings serialization
 template <>
 void DataStreamReader::read(const Protocols::LSLSpecificSettings& n)
 {
-  m_stream << n.streamTypeFilter << n.subscribedStreams << n.outboundSensors;
+  m_stream << n.streamTypeFilter << n.subscribedStreams << n.outboundSensors
+           << n.inletConfigs << n.inletThreads << n.nameFilter << n.hostFilter
+           << n.sourceIdFilter << n.alignedStreams << n.alignmentRate << n.alignmentDelay;
   insertDelimiter();
 }
 
 template <>
 void DataStreamWriter::write(Protocols::LSLSpecificSettings& n)
 {
-  m_stream >> n.streamTypeFilter >> n.subscribedStreams >> n.outboundSensors;
+  m_stream >> n.streamTypeFilter >> n.subscribedStreams >> n.outboundSensors
+      >> n.inletConfigs >> n.inletThreads >> n.nameFilter >> n.hostFilter
+      >> n.sourceIdFilter >> n.alignedStreams >> n.alignmentRate >> n.alignmentDelay;
   checkDelimiter();
 }
 
@@ -68,6 +140,14 @@ void JSONReader::read(const Protocols::LSLSpecificSettings& n)
   obj["StreamTypeFilter"] = n.streamTypeFilter;
   obj["SubscribedStreams"] = n.subscribedStreams;
   obj["OutboundSensors"] = n.outboundSensors;
+  obj["InletConfigs"] = n.inletConfigs;
+  obj["InletThreads"] = n.inletThreads;
+  obj["NameFilter"] = n.nameFilter;
+  obj["HostFilter"] = n.hostFilter;
+  obj["SourceIdFilter"] = n.sourceIdFilter;
+  obj["AlignedStreams"] = n.alignedStreams;
+  obj["AlignmentRate"] = n.alignmentRate;
+  obj["AlignmentDelay"] = n.alignmentDelay;
 }
 
 template <>
@@ -79,4 +159,20 @@ void JSONWriter::write(Protocols::LSLSpecificSettings& n)
     n.subscribedStreams <<= *it;
   if (auto it = obj.tryGet("OutboundSensors"))
     n.outboundSensors <<= *it;
+  if (auto it = obj.tryGet("InletConfigs"))
+    n.inletConfigs <<= *it;
+  if (auto it = obj.tryGet("InletThreads"))
+    n.inletThreads <<= *it;
+  if (auto it = obj.tryGet("NameFilter"))
+    n.nameFilter <<= *it;
+  if (auto it = obj.tryGet("HostFilter"))
+    n.hostFilter <<= *it;
+  if (auto it = obj.tryGet("SourceIdFilter"))
+    n.sourceIdFilter <<= *it;
+  if (auto it = obj.tryGet("AlignedStreams"))
+    n.alignedStreams <<= *it;
+  if (auto it = obj.tryGet("AlignmentRate"))
+    n.alignmentRate <<= *it;
+  if (auto it = obj.tryGet("AlignmentDelay"))
+    n.alignmentDelay <<= *it;
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+#include <ossia/network/value/value.hpp>
+
+#include <lsl_cpp.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace lsl_protocol
+{
+
+// Compile-time description of each supported LSL channel format:
+// the type of the samples exchanged with liblsl and how they map to ossia values,
+// in both directions (inlets use to_value, outlets use from_value).
+template <lsl::channel_format_t Format>
+struct lsl_format_traits;
+
+template <>
+struct lsl_format_traits<lsl::cf_float32>
+{
+  using sample_type = float;
+  static ossia::value to_value(float v) noexcept { return v; }
+  static float from_value(const ossia::value& v) { return ossia::convert<float>(v); }
+};
+
+template <>
+struct lsl_format_traits<lsl::cf_double64>
+{
+  using sample_type = double;
+  static ossia::value to_value(double v) noexcept { return static_cast<float>(v); }
+  static double from_value(const ossia::value& v) { return ossia::convert<double>(v); }
+};
+
+template <>
+struct lsl_format_traits<lsl::cf_int32>
+{
+  using sample_type = int32_t;
+  static ossia::value to_value(int32_t v) noexcept { return static_cast<int>(v); }
+  static int32_t from_value(const ossia::value& v) { return ossia::convert<int>(v); }
+};
+
+template <>
+struct lsl_format_traits<lsl::cf_int16>
+{
+  using sample_type = int16_t;
+  static ossia::value to_value(int16_t v) noexcept { return static_cast<int>(v); }
+  static int16_t from_value(const ossia::value& v)
+  {
+    return static_cast<int16_t>(std::clamp(ossia::convert<int>(v), -32768, 32767));
+  }
+};
+
+template <>
+struct lsl_format_traits<lsl::cf_int8>
+{
+  // liblsl exchanges int8 samples as char
+  using sample_type = char;
+  static ossia::value to_value(char v) noexcept
+  {
+    return static_cast<int>(static_cast<int8_t>(v));
+  }
+  static char from_value(const ossia::value& v)
+  {
+    return static_cast<char>(std::clamp(ossia::convert<int>(v), -128, 127));
+  }
+};
+
+template <>
+struct lsl_format_traits<lsl::cf_int64>
+{
+  // ossia integers are 32 bits: larger values saturate
+  using sample_type = int64_t;
+  static ossia::value to_value(int64_t v) noexcept
+  {
+    return static_cast<int>(std::clamp<int64_t>(
+        v, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()));
+  }
+  static int64_t from_value(const ossia::value& v) { return ossia::convert<int>(v); }
+};
+
+template <>
+struct lsl_format_traits<lsl::cf_string>
+{
+  using sample_type = std::string;
+  static ossia::value to_value(const std::string& v) { return v; }
+  static std::string from_value(const ossia::value& v)
+  {
+    if(auto str = v.target<std::string>())
+      return *str;
+    return ossia::convert<std::string>(v);
+  }
+};
+
+// Storage for multiplexed samples of any format, allocated once as the vector
+// of the sample_type of the format
+using lsl_sample_buffer = std::variant<
+    std::monostate, std::vector<float>, std::vector<double>, std::vector<int32_t>,
+    std::vector<int16_t>, std::vector<char>, std::vector<int64_t>, std::vector<std::string>>;
+
+template <lsl::channel_format_t Format>
+using lsl_format_constant = std::integral_constant<lsl::channel_format_t, Format>;
+
+// Calls f(lsl_format_constant<F>{}) for the runtime format fmt, so that the caller
+// can pick a specialised implementation once instead of switching on every sample.
+// Returns false if the format is not supported.
+template <typename F>
+bool dispatch_channel_format(lsl::channel_format_t fmt, F&& f)
+{
+  switch(fmt)
+  {
+    case lsl::cf_float32:
+      f(lsl_format_constant<lsl::cf_float32>{});
+      return true;
+    case lsl::cf_double64:
+      f(lsl_format_constant<lsl::cf_double64>{});
+      return true;
+    case lsl::cf_int32:
+      f(lsl_format_constant<lsl::cf_int32>{});
+      return true;
+    case lsl::cf_int16:
+      f(lsl_format_constant<lsl::cf_int16>{});
+      return true;
+    case lsl::cf_int8:
+      f(lsl_format_constant<lsl::cf_int8>{});
+      return true;
+    case lsl::cf_int64:
+      f(lsl_format_constant<lsl::cf_int64>{});
+      return true;
+    case lsl::cf_string:
+      f(lsl_format_constant<lsl::cf_string>{});
+      return true;
+    default:
+      return false;
+  }
+}
+
+}
@@ -6,9 +6,36 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace lsl_protocol
 {
 
+namespace
+{
+// Number of frames pulled at once: about 100 ms worth of data for regular streams.
+// Marker streams get room for bursts.
+std::size_t chunk_frames_for(const lsl_stream_data& stream)
+{
+  if(stream.nominal_srate <= 0.)
+    return 256;
+  return std::clamp<std::size_t>(std::size_t(stream.nominal_srate / 10.), 32, 4096);
+}
+
+// Chunks kept in the ring of a shared inlet for the subscribers lagging behind.
+// Marker streams keep more, so that a burst does not overrun a subscriber.
+constexpr std::size_t ring_chunks = 4;
+constexpr std::size_t marker_ring_chunks = 16;
+
+// Bounds on the time spent resolving and connecting a subscribed stream, in seconds
+constexpr double resolve_timeout = 2.0;
+constexpr double open_timeout = 5.0;
+
+// Bound on the wait for a clock offset estimate of a stream, in seconds
+constexpr double clock_timeout = 0.5;
+}
+
 ossia::val_type lsl_format_to_ossia_type(lsl::channel_format_t fmt)
 {
   switch(fmt)
@@ -42,10 +69,14 @@ ossia::domain get_domain_for_lsl_format(lsl::channel_format_t fmt)
 }
 
 lsl_context::lsl_context()
-    : m_streams_buffer{{}}
+    : m_clock_epoch{lsl::local_clock()}
 {
   // Start discovery thread
   m_discovery_thread = std::thread(&lsl_context::discovery_thread, this);
+
+  // Clock offsets are estimated away from the inlet workers:
+  // a first estimate can block for up to clock_timeout
+  m_clock_thread = std::thread(&lsl_context::clock_thread, this);
 }
 
 lsl_context::~lsl_context()
@@ -54,112 +85,481 @@ lsl_context::~lsl_context()
   
   if (m_discovery_thread.joinable())
     m_discovery_thread.join();
+  if (m_clock_thread.joinable())
+    m_clock_thread.join();
+}
+
+void lsl_context::acquire_discovery(const std::string& predicate)
+{
+  std::lock_guard<std::mutex> lock(m_queries_mutex);
+  auto& query = m_queries[predicate];
+  if(!query)
+  {
+    query = std::make_shared<discovery_query>();
+    query->predicate = predicate;
+    query->snapshot = std::make_shared<const lsl_stream_map>();
+  }
+  query->users++;
+}
+
+void lsl_context::release_discovery(const std::string& predicate)
+{
+  std::lock_guard<std::mutex> lock(m_queries_mutex);
+  auto it = m_queries.find(predicate);
+  if(it != m_queries.end() && --it->second->users <= 0)
+    m_queries.erase(it);
+}
+
+std::string lsl_context::make_predicate(const lsl_stream_filter& filter)
+{
+  std::vector<std::string> clauses;
+
+  auto add_clause = [&](const std::string& field, const std::string& patterns) {
+    std::vector<std::string> alternatives;
+    std::vector<std::string> split;
+    boost::split(split, patterns, boost::is_any_of(","));
+    for(auto& pattern : split)
+    {
+      boost::trim(pattern);
+      const bool wild_start = pattern.starts_with('*');
+      const bool wild_end = pattern.ends_with('*');
+      if(wild_start)
+        pattern.erase(0, 1);
+      if(wild_end && !pattern.empty())
+        pattern.pop_back();
+      if(pattern.empty())
+        continue;
+
+      // XPath 1.0 literals cannot be escaped, only quoted with ' or "
+      std::string literal;
+      if(pattern.find('\'') == std::string::npos)
+        literal = "'" + pattern + "'";
+      else if(pattern.find('"') == std::string::npos)
+        literal = "\"" + pattern + "\"";
+      else
+        continue;
+
+      if(wild_start && wild_end)
+        alternatives.push_back("contains(" + field + "," + literal + ")");
+      else if(wild_end)
+        alternatives.push_back("starts-with(" + field + "," + literal + ")");
+      else if(wild_start)
+        alternatives.push_back(
+            "substring(" + field + ",string-length(" + field + ")-string-length(" + literal
+            + ")+1)=" + literal);
+      else
+        alternatives.push_back(field + "=" + literal);
+    }
+
+    if(alternatives.size() == 1)
+      clauses.push_back(alternatives.front());
+    else if(alternatives.size() > 1)
+      clauses.push_back("(" + boost::join(alternatives, " or ") + ")");
+  };
+
+  add_clause("type", filter.type);
+  add_clause("name", filter.name);
+  add_clause("hostname", filter.hostname);
+  add_clause("source_id", filter.source_id);
+  return boost::join(clauses, " and ");
+}
+
+lsl_stream_snapshot lsl_context::get_current_streams(const std::string& predicate) const
+{
+  std::lock_guard<std::mutex> lock(m_queries_mutex);
+  auto it = m_queries.find(predicate);
+  if(it == m_queries.end())
+    return std::make_shared<const lsl_stream_map>();
+  return it->second->snapshot;
+}
+
+std::shared_ptr<const lsl_stream_data>
+lsl_context::find_stream(const std::string& uid, const std::string& predicate) const
+{
+  auto snapshot = get_current_streams(predicate);
+  auto it = snapshot->find(uid);
+  if(it == snapshot->end())
+    return {};
+
+  // Shares ownership of the whole snapshot
+  return std::shared_ptr<const lsl_stream_data>(snapshot, &it->second);
+}
+
+std::optional<lsl::stream_info> lsl_context::find_stream_info(const std::string& uid) const
+{
+  std::lock_guard<std::mutex> lock(m_queries_mutex);
+  for(const auto& [predicate, query] : m_queries)
+  {
+    auto it = query->infos.find(uid);
+    if(it != query->infos.end())
+      return it->second;
+  }
+  return std::nullopt;
+}
+
+std::shared_ptr<const lsl_stream_data> lsl_context::describe_stream(const std::string& uid)
+{
+  auto info = find_stream_info(uid);
+  if(!info)
+    return {};
+  return describe_stream(*info);
+}
+
+std::shared_ptr<const lsl_stream_data> lsl_context::describe_stream(lsl::stream_info& info)
+{
+  const auto uid = info.uid();
+  const double created_at = info.created_at();
+  const bool has_desc = !info.desc().first_child().empty();
+  {
+    std::lock_guard<std::mutex> lock(m_metadata_mutex);
+    auto it = m_metadata.find(uid);
+    if(it != m_metadata.end() && it->second.created_at == created_at
+       && (!has_desc || !it->second.stream->channels.empty()))
+      return it->second.stream;
+  }
+
+  // Parsed outside of the lock: two threads may race to parse the same stream,
+  // the result is identical
+  auto stream = std::make_shared<const lsl_stream_data>(make_stream_data(info));
+  if(has_desc)
+  {
+    std::lock_guard<std::mutex> lock(m_metadata_mutex);
+    m_metadata.insert_or_assign(uid, stream_metadata{created_at, stream});
+  }
+  return stream;
+}
+
+std::shared_ptr<lsl_shared_inlet>
+lsl_context::acquire_inlet(const std::string& uid, const lsl_buffer_options& buffering)
+{
+  const std::string key = uid + '/' + std::to_string(buffering.max_buflen) + '/'
+                          + std::to_string(buffering.max_chunklen) + '/'
+                          + std::to_string(buffering.recover) + '/'
+                          + std::to_string(buffering.postprocessing) + '/'
+                          + std::to_string(buffering.history);
+
+  std::promise<std::shared_ptr<lsl_shared_inlet>> promise;
+  std::shared_future<std::shared_ptr<lsl_shared_inlet>> pending;
+  {
+    std::lock_guard<std::mutex> lock(m_inlets_mutex);
+    std::erase_if(m_inlets, [](const auto& entry) {
+      return entry.second.inlet.expired() && !entry.second.opening.valid();
+    });
+
+    auto& entry = m_inlets[key];
+    if(auto inlet = entry.inlet.lock())
+      return inlet;
+
+    if(entry.opening.valid())
+      pending = entry.opening;
+    else
+      entry.opening = promise.get_future().share();
+  }
+
+  // Another device is connecting to this stream: wait for it outside of the lock
+  if(pending.valid())
+    return pending.get();
+
+  // Resolving and connecting can take seconds, no lock is held meanwhile
+  auto inlet = open_inlet(uid, buffering);
+  {
+    std::lock_guard<std::mutex> lock(m_inlets_mutex);
+    auto& entry = m_inlets[key];
+    entry.inlet = inlet;
+    entry.opening = {};
+  }
+  promise.set_value(inlet);
+  return inlet;
+}
+
+std::shared_ptr<lsl_shared_inlet>
+lsl_context::open_inlet(const std::string& uid, const lsl_buffer_options& buffering)
+{
+  try
+  {
+    // Use the stream_info already resolved by the discovery when possible
+    auto info = find_stream_info(uid);
+    if(!info)
+    {
+      std::vector<lsl::stream_info> results
+          = lsl::resolve_stream("uid", uid, 1, resolve_timeout);
+      if(results.empty())
+      {
+        ossia::logger().error("Failed to resolve stream: {}", uid);
+        return {};
+      }
+      info = std::move(results[0]);
+    }
+
+    auto shared = std::make_shared<lsl_shared_inlet>();
+    shared->inlet = std::make_unique<lsl::stream_inlet>(
+        *info, buffering.max_buflen, buffering.max_chunklen, buffering.recover);
+    if(buffering.postprocessing != lsl::post_none)
+      shared->inlet->set_postprocessing(buffering.postprocessing);
+    shared->clock_synced = buffering.postprocessing & lsl::post_clocksync;
+    shared->inlet->open_stream(open_timeout);
+
+    // Resolved stream_infos have no description: the full one comes from the inlet,
+    // its channel metadata is parsed once and cached
+    auto full_info = shared->inlet->info(open_timeout);
+    shared->stream = describe_stream(full_info);
+
+    // Allocate the ring once, it is reused on every pull
+    const auto& stream = *shared->stream;
+    shared->chunk_frames = chunk_frames_for(stream);
+    shared->capacity = shared->chunk_frames
+                       * (stream.nominal_srate <= 0. ? marker_ring_chunks : ring_chunks);
+    if(buffering.history > 0. && stream.nominal_srate > 0.)
+    {
+      // A pull overwrites up to a chunk of the oldest frames
+      const auto history
+          = static_cast<std::size_t>(std::ceil(buffering.history * stream.nominal_srate));
+      shared->capacity = std::max(shared->capacity, history + shared->chunk_frames);
+    }
+    shared->timestamps.resize(shared->capacity);
+    const std::size_t elements = shared->capacity * stream.channel_count;
+    if(!dispatch_channel_format(
+           stream.channel_format, [&]<lsl::channel_format_t F>(lsl_format_constant<F>) {
+             using sample_type = typename lsl_format_traits<F>::sample_type;
+             shared->frames.emplace<std::vector<sample_type>>(elements);
+           }))
+    {
+      ossia::logger().error("Unsupported channel format for stream: {}", uid);
+      return {};
+    }
+    return shared;
+  }
+  catch(const std::exception& e)
+  {
+    ossia::logger().error("Failed to open stream {}: {}", uid, e.what());
+    return {};
+  }
+}
+
+lsl_stream_data lsl_context::make_stream_header(lsl::stream_info& info)
+{
+  lsl_stream_data stream;
+  stream.uid = info.uid();
+  stream.name = info.name();
+  stream.type = info.type();
+  stream.channel_count = info.channel_count();
+  stream.nominal_srate = info.nominal_srate();
+  stream.channel_format = info.channel_format();
+
+  // Extract metadata
+  stream.source_id = info.source_id();
+  stream.hostname = info.hostname();
+  return stream;
 }
 
-lsl_stream_map lsl_context::get_current_streams()
+lsl_stream_data lsl_context::make_stream_data(lsl::stream_info& info)
 {
-  m_streams_buffer.consume(m_previous_streams_consumer_thread);
-  return m_previous_streams_consumer_thread;
+  lsl_stream_data stream = make_stream_header(info);
+
+  // Get manufacturer info if available
+  lsl::xml_element desc = info.desc();
+  if(!desc.first_child().empty())
+  {
+    lsl::xml_element manufacturer = desc.child("manufacturer");
+    if(!manufacturer.empty())
+      stream.manufacturer = manufacturer.child_value();
+
+    lsl::xml_element model = desc.child("model");
+    if(!model.empty())
+      stream.model = model.child_value();
+
+    lsl::xml_element serial = desc.child("serial_number");
+    if(!serial.empty())
+      stream.serial_number = serial.child_value();
+  }
+
+  // Parse channel information
+  stream.channels = parse_channel_info(info);
+  return stream;
 }
 
-void lsl_context::register_stream_callback(stream_callback cb)
+lsl_context::callback_handle
+lsl_context::register_stream_callback(stream_callback cb, const std::string& predicate)
 {
   std::lock_guard<std::mutex> lock(m_callbacks_mutex);
-  m_callbacks.push_back(cb);
+  const auto handle = m_next_callback_handle++;
+  m_callbacks.push_back({handle, predicate, std::move(cb)});
+  return handle;
 }
 
-void lsl_context::unregister_stream_callback(stream_callback cb)
+void lsl_context::unregister_stream_callback(callback_handle handle)
 {
   std::lock_guard<std::mutex> lock(m_callbacks_mutex);
-  // Note: std::function doesn't support == operator, so we can't directly remove
-  // In practice, we might need a more sophisticated callback management system
-  m_callbacks.clear();
+  std::erase_if(m_callbacks, [handle](const auto& cb) { return cb.handle == handle; });
 }
 
 void lsl_context::discovery_thread()
 {
-
   while(m_running)
   {
-    try
+    // Queries released meanwhile stay alive until the end of the pass
+    std::vector<std::shared_ptr<discovery_query>> queries;
     {
-      // Discover all streams
-      std::vector<lsl::stream_info> streams = lsl::resolve_streams(2.0);
-
-      lsl_stream_map new_streams;
+      std::lock_guard<std::mutex> lock(m_queries_mutex);
+      for(const auto& [predicate, query] : m_queries)
+        queries.push_back(query);
+    }
 
-      for(auto& info : streams)
+    for(auto& query : queries)
+    {
+      try
       {
-        lsl_stream_data stream;
-        stream.uid = info.uid();
-        stream.name = info.name();
-        stream.type = info.type();
-        stream.channel_count = info.channel_count();
-        stream.nominal_srate = info.nominal_srate();
-        stream.channel_format = info.channel_format();
-        
-        // Extract metadata
-        stream.source_id = info.source_id();
-        stream.hostname = info.hostname();
-
-        // Get manufacturer info if available
-        lsl::xml_element desc = info.desc();
-        if(!desc.first_child().empty())
-        {
-          lsl::xml_element manufacturer = desc.child("manufacturer");
-          if(!manufacturer.empty())
-            stream.manufacturer = manufacturer.child_value();
-            
-          lsl::xml_element model = desc.child("model");
-          if(!model.empty())
-            stream.model = model.child_value();
-            
-          lsl::xml_element serial = desc.child("serial_number");
-          if(!serial.empty())
-            stream.serial_number = serial.child_value();
-        }
-        
-        // Parse channel information
-        stream.channels = parse_channel_info(info);
-
-        new_streams[stream.uid] = stream;
+        update_query(*query);
       }
+      catch (const std::exception& e)
+      {
+      }
+    }
+    queries.clear();
 
-      // Update the buffer
-      update_streams_in_buffer(new_streams);
+    // Sleep for discovery interval
+    for (auto t = std::chrono::milliseconds{0}; t < m_discovery_interval && m_running;
+         t += std::chrono::milliseconds(50))
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
-    catch (const std::exception& e)
+  }
+}
+
+void lsl_context::clock_thread()
+{
+  while(m_running)
+  {
+    std::vector<std::shared_ptr<lsl_shared_inlet>> inlets;
     {
+      std::lock_guard<std::mutex> lock(m_inlets_mutex);
+      for(const auto& [uid, entry] : m_inlets)
+        if(auto inlet = entry.inlet.lock())
+          inlets.push_back(std::move(inlet));
     }
 
-    // Sleep for discovery interval
-    for (int i = 0; i < m_discovery_interval.count() * 10 && m_running; ++i)
+    // liblsl refreshes its estimate in the background,
+    // asking for it again is cheap once the first one is known
+    for(auto& inlet : inlets)
     {
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      if(!m_running)
+        break;
+      try
+      {
+        inlet->clock_offset = inlet->inlet->time_correction(clock_timeout);
+      }
+      catch (const std::exception& e)
+      {
+        // Keep the previous estimate until the stream answers again
+      }
+    }
+    inlets.clear();
+
+    for (auto t = std::chrono::milliseconds{0}; t < m_clock_interval && m_running;
+         t += std::chrono::milliseconds(50))
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
   }
 }
 
-void lsl_context::update_streams_in_buffer(lsl_stream_map new_streams)
+void lsl_context::update_query(discovery_query& query)
 {
-  if(m_previous_streams_producer_thread != new_streams)
+  // Keeps resolving in the background; streams not seen for forget_after seconds drop out
+  if(!query.resolver)
   {
-    m_previous_streams_producer_thread = new_streams;
+    if(query.predicate.empty())
+      query.resolver.emplace(m_forget_after);
+    else
+      query.resolver.emplace(query.predicate, m_forget_after);
+  }
 
-    m_streams_buffer.produce(new_streams);
+  std::vector<lsl::stream_info> results = query.resolver->results();
 
-    std::vector<stream_callback> callbacks_copy;
+  // Only the streams that were not known yet, or that were re-created under the
+  // same UID, are read. Only the header is kept: the channel metadata is parsed
+  // when a stream is described or subscribed.
+  lsl_stream_delta delta;
+  std::vector<std::pair<std::string, lsl::stream_info>> new_infos;
+  std::unordered_set<std::string> seen;
+  seen.reserve(results.size());
+  for(auto& info : results)
+  {
+    auto uid = info.uid();
+    const double created_at = info.created_at();
+    auto known = query.created.find(uid);
+    if(known == query.created.end() || known->second != created_at)
     {
-      std::lock_guard<std::mutex> lock(m_callbacks_mutex);
-      callbacks_copy = m_callbacks;
+      auto stream = make_stream_header(info);
+      if(known == query.created.end())
+        delta.added.push_back(stream);
+      else
+        delta.changed.push_back(stream);
+
+      query.streams.insert_or_assign(uid, std::move(stream));
+      query.created.insert_or_assign(uid, created_at);
+      new_infos.emplace_back(uid, info);
     }
+    seen.insert(std::move(uid));
+  }
 
-    for(const auto& cb : callbacks_copy)
+  for(auto it = query.streams.begin(); it != query.streams.end();)
+  {
+    if(!seen.contains(it->first))
+    {
+      query.created.erase(it->first);
+      delta.removed.push_back(it->first);
+      it = query.streams.erase(it);
+    }
+    else
     {
-      if (cb)
-        cb();
+      ++it;
     }
   }
+
+  if(delta.empty())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_queries_mutex);
+    for(auto& [uid, info] : new_infos)
+      query.infos.insert_or_assign(uid, std::move(info));
+    for(const auto& uid : delta.removed)
+      query.infos.erase(uid);
+  }
+  if(!delta.removed.empty())
+  {
+    std::lock_guard<std::mutex> lock(m_metadata_mutex);
+    for(const auto& uid : delta.removed)
+      m_metadata.erase(uid);
+  }
+
+  // Update the buffer
+  update_streams_in_buffer(query, delta);
+}
+
+void lsl_context::update_streams_in_buffer(
+    discovery_query& query, const lsl_stream_delta& delta)
+{
+  auto snapshot = std::make_shared<const lsl_stream_map>(query.streams);
+  {
+    std::lock_guard<std::mutex> lock(m_queries_mutex);
+    query.snapshot = std::move(snapshot);
+  }
+
+  std::vector<stream_callback> callbacks_copy;
+  {
+    std::lock_guard<std::mutex> lock(m_callbacks_mutex);
+    for(const auto& cb : m_callbacks)
+      if(cb.predicate == query.predicate)
+        callbacks_copy.push_back(cb.callback);
+  }
+
+  for(const auto& cb : callbacks_copy)
+  {
+    if (cb)
+      cb(delta);
+  }
 }
 
 std::vector<lsl_channel_info> lsl_context::parse_channel_info(lsl::stream_info& info)
@@ -199,6 +599,23 @@ std::vector<lsl_channel_info> lsl_context::parse_channel_info(lsl::stream_info&
       ch_info.lsl_format = info.channel_format();
       ch_info.ossia_type = lsl_format_to_ossia_type(info.channel_format());
       
+      // Quantised channels, e.g. from the quantised outlets of this addon
+      lsl::xml_element quantization = ch.child("quantization");
+      if(!quantization.empty())
+      {
+        try
+        {
+          ch_info.scale = std::stod(quantization.child_value("scale"));
+          ch_info.offset = std::stod(quantization.child_value("offset"));
+          ch_info.quantized = true;
+          ch_info.ossia_type = ossia::val_type::FLOAT;
+        }
+        catch (...)
+        {
+          // Ignore parsing errors
+        }
+      }
+
       // Parse range if available
       lsl::xml_element range = ch.child("range");
       if(!range.empty())
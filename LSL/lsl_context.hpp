@@ -1,18 +1,25 @@
 #pragma once
 #include <ossia/detail/logger.hpp>
-#include <ossia/detail/triple_buffer.hpp>
 #include <ossia/network/context.hpp>
 
+#include <LSL/lsl_codec.hpp>
 #include <LSL/lsl_structs.hpp>
 
 #include <lsl_cpp.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <future>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <variant>
 #include <vector>
 
 namespace lsl_protocol
@@ -23,37 +30,224 @@ struct lsl_stream_data;
 
 using lsl_stream_map = std::unordered_map<std::string, lsl_stream_data>;
 
+// Immutable snapshot of the discovered streams, shared by all readers
+using lsl_stream_snapshot = std::shared_ptr<const lsl_stream_map>;
+
+// What changed in the discovered streams since the previous notification
+struct lsl_stream_delta
+{
+  std::vector<lsl_stream_data> added;
+  std::vector<std::string> removed;
+  std::vector<lsl_stream_data> changed;
+
+  bool empty() const noexcept { return added.empty() && removed.empty() && changed.empty(); }
+};
+
+// An inlet shared by every device subscribed to the same stream. Samples are pulled
+// from the network once, into a ring of typed frames that each subscriber reads from
+// its own position. Subscribers hold a shared_ptr: the inlet closes with the last one.
+// Pulling never waits for the subscribers: one lagging behind only loses its own frames.
+struct lsl_shared_inlet
+{
+  std::unique_ptr<lsl::stream_inlet> inlet;
+  std::shared_ptr<const lsl_stream_data> stream;
+
+  // Held while pulling and while reading the ring
+  std::mutex mutex;
+
+  // Ring of multiplexed frames: frame n is stored at (n % capacity) * channel_count.
+  // A subscriber more than capacity frames behind loses the oldest ones.
+  lsl_sample_buffer frames;
+  std::vector<double> timestamps;
+  std::size_t chunk_frames{};
+  std::size_t capacity{};
+  std::uint64_t head{}; // Number of frames pulled since the inlet was opened
+
+  // Seconds to add to the stream timestamps to map them to the local LSL clock,
+  // kept up to date by the clock thread of the context
+  std::atomic<double> clock_offset{0.};
+
+  // With the post_clocksync post-processing, liblsl already maps the timestamps
+  bool clock_synced{false};
+
+  // Offset to add to the timestamps of the ring
+  double correction() const noexcept { return clock_synced ? 0. : clock_offset.load(); }
+
+  // Pulls at most one chunk from the network into the ring. Returns false when the
+  // chunk was not full, i.e. there is nothing left to pull.
+  template <lsl::channel_format_t Format>
+  bool fetch()
+  {
+    using sample_type = typename lsl_format_traits<Format>::sample_type;
+    auto& ring = *std::get_if<std::vector<sample_type>>(&frames);
+
+    const std::size_t channels = stream->channel_count;
+    const std::size_t slot = head % capacity;
+    const std::size_t max_frames = std::min(chunk_frames, capacity - slot);
+    const std::size_t elements = inlet->pull_chunk_multiplexed(
+        ring.data() + slot * channels, timestamps.data() + slot, max_frames * channels,
+        max_frames, 0.0);
+    const std::size_t pulled = elements / channels;
+    head += pulled;
+    return pulled == max_frames;
+  }
+
+  template <lsl::channel_format_t Format>
+  const typename lsl_format_traits<Format>::sample_type* frame(std::uint64_t n) const
+  {
+    using sample_type = typename lsl_format_traits<Format>::sample_type;
+    const auto& ring = *std::get_if<std::vector<sample_type>>(&frames);
+    return ring.data() + (n % capacity) * stream->channel_count;
+  }
+
+  double timestamp(std::uint64_t n) const { return timestamps[n % capacity]; }
+
+  // Oldest frame still in the ring
+  std::uint64_t tail() const noexcept { return head > capacity ? head - capacity : 0; }
+
+  // Copies the frames [first, first + count) out of the ring, so that they can be
+  // published without holding the mutex
+  template <lsl::channel_format_t Format>
+  void copy_frames(
+      std::uint64_t first, std::size_t count,
+      typename lsl_format_traits<Format>::sample_type* out, double* out_timestamps) const
+  {
+    const std::size_t channels = stream->channel_count;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+      const auto* f = frame<Format>(first + i);
+      std::copy(f, f + channels, out + i * channels);
+      out_timestamps[i] = timestamp(first + i);
+    }
+  }
+};
+
 class lsl_context
 {
 public:
   lsl_context();
   ~lsl_context();
 
-  // Get current streams (thread-safe)
-  lsl_stream_map get_current_streams();
+  // Discovery only runs for the queries someone asked for. The predicate is an
+  // LSL / XPath query such as "type='EEG'", the empty predicate matches all streams.
+  // Non-matching streams are filtered by liblsl and never parsed.
+  void acquire_discovery(const std::string& predicate = {});
+  void release_discovery(const std::string& predicate = {});
+
+  // Builds the predicate matching a filter
+  static std::string make_predicate(const lsl_stream_filter& filter);
+
+  // Get current streams of a query (thread-safe). The snapshot is never modified:
+  // discovery publishes a new one when the streams change.
+  lsl_stream_snapshot get_current_streams(const std::string& predicate = {}) const;
+
+  // Look up one stream of the current snapshot, without copying it (thread-safe)
+  std::shared_ptr<const lsl_stream_data>
+  find_stream(const std::string& uid, const std::string& predicate = {}) const;
+
+  // The stream_info last resolved for a stream by any query, usable to open
+  // an inlet without resolving it again (thread-safe)
+  std::optional<lsl::stream_info> find_stream_info(const std::string& uid) const;
+
+  // The full metadata of a stream (manufacturer and channel descriptions), parsed on
+  // first access and cached by UID until the stream is re-created. Discovery results
+  // only carry the header: the overload taking a stream_info should be given the
+  // full info of an inlet, e.g. when subscribing (thread-safe).
+  std::shared_ptr<const lsl_stream_data> describe_stream(const std::string& uid);
+  std::shared_ptr<const lsl_stream_data> describe_stream(lsl::stream_info& info);
+
+  // Extracts the header fields of a stream_info: cheap, no XML is walked
+  static lsl_stream_data make_stream_header(lsl::stream_info& info);
+
+  // Extracts the stream data and channel metadata from a stream_info
+  static lsl_stream_data make_stream_data(lsl::stream_info& info);
+
+  // Opens an inlet on a stream, or shares the one already opened by another device
+  // with the same buffering options. Concurrent requests for the same stream wait for
+  // a single connection. Returns null if the stream could not be resolved or opened.
+  std::shared_ptr<lsl_shared_inlet>
+  acquire_inlet(const std::string& uid, const lsl_buffer_options& buffering = {});
 
-  // Register callback for stream changes
-  using stream_callback = std::function<void()>;
-  void register_stream_callback(stream_callback cb);
-  void unregister_stream_callback(stream_callback cb);
+  // Origin of the relative timestamps exposed to score: the local LSL clock
+  // when the context was created, shared by every device
+  double clock_epoch() const noexcept { return m_clock_epoch; }
+
+  // Register callback for the stream changes of a query, called from the discovery
+  // thread. The returned handle is used to unregister it.
+  using stream_callback = std::function<void(const lsl_stream_delta&)>;
+  using callback_handle = uint64_t;
+  callback_handle
+  register_stream_callback(stream_callback cb, const std::string& predicate = {});
+  void unregister_stream_callback(callback_handle handle);
 
 private:
+  struct discovery_query
+  {
+    std::string predicate;
+    int users{};
+
+    // Only touched by the discovery thread
+    std::optional<lsl::continuous_resolver> resolver;
+    lsl_stream_map streams;
+    std::unordered_map<std::string, double> created;
+
+    // Protected by m_queries_mutex
+    lsl_stream_snapshot snapshot;
+    std::unordered_map<std::string, lsl::stream_info> infos;
+  };
+
   void discovery_thread();
-  void update_streams_in_buffer(lsl_stream_map new_streams);
-  std::vector<lsl_channel_info> parse_channel_info(lsl::stream_info& info);
+  void clock_thread();
+  void update_query(discovery_query& query);
+  void update_streams_in_buffer(discovery_query& query, const lsl_stream_delta& delta);
+  static std::vector<lsl_channel_info> parse_channel_info(lsl::stream_info& info);
+  std::shared_ptr<lsl_shared_inlet>
+  open_inlet(const std::string& uid, const lsl_buffer_options& buffering);
 
-  mutable ossia::triple_buffer<lsl_stream_map> m_streams_buffer;
+  // The mutex guards the set of queries, and swapping and copying their snapshot
+  // pointers and stream_info caches, but not the snapshot data
+  std::unordered_map<std::string, std::shared_ptr<discovery_query>> m_queries;
+  mutable std::mutex m_queries_mutex;
   
+  struct stream_metadata
+  {
+    double created_at{};
+    std::shared_ptr<const lsl_stream_data> stream;
+  };
+  std::unordered_map<std::string, stream_metadata> m_metadata;
+  std::mutex m_metadata_mutex;
+
+  // Inlet pool, by UID and buffering options: the entries expire with their last subscriber
+  struct inlet_entry
+  {
+    std::weak_ptr<lsl_shared_inlet> inlet;
+    std::shared_future<std::shared_ptr<lsl_shared_inlet>> opening;
+  };
+  std::unordered_map<std::string, inlet_entry> m_inlets;
+  std::mutex m_inlets_mutex;
+
   std::thread m_discovery_thread;
+  std::thread m_clock_thread;
   std::atomic<bool> m_running{true};
-  
-  std::vector<stream_callback> m_callbacks;
+  double m_clock_epoch{};
+
+  struct callback_entry
+  {
+    callback_handle handle{};
+    std::string predicate;
+    stream_callback callback;
+  };
+  std::vector<callback_entry> m_callbacks;
+  callback_handle m_next_callback_handle{1};
   std::mutex m_callbacks_mutex;
 
-  std::chrono::seconds m_discovery_interval{2};
+  // How often the continuous resolver results are checked,
+  // and after how long a stream that stopped answering is dropped
+  std::chrono::milliseconds m_discovery_interval{250};
+  double m_forget_after{5.0};
 
-  lsl_stream_map m_previous_streams_producer_thread;
-  lsl_stream_map m_previous_streams_consumer_thread;
+  // How often the clock offsets of the open inlets are refreshed
+  std::chrono::milliseconds m_clock_interval{1000};
 };
 
 }
@@ -0,0 +1,91 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace lsl_protocol
+{
+
+// Conversion kernels between the typed LSL sample buffers and the float arrays
+// exchanged with ossia. They are plain loops over contiguous arrays, without branches
+// the compiler cannot turn into selects, so that they are vectorised for every
+// sample type. Values are only boxed into ossia::value around them.
+
+// liblsl exchanges int8 samples as char, which is unsigned on some platforms:
+// the kernels only see them through kernel_samples, as int8_t.
+template <typename T>
+using kernel_sample_t = std::conditional_t<std::is_same_v<T, char>, std::int8_t, T>;
+
+template <typename T>
+const kernel_sample_t<T>* kernel_samples(const T* p) noexcept
+{
+  return reinterpret_cast<const kernel_sample_t<T>*>(p);
+}
+
+template <typename T>
+kernel_sample_t<T>* kernel_samples(T* p) noexcept
+{
+  return reinterpret_cast<kernel_sample_t<T>*>(p);
+}
+
+// Widening or narrowing conversion, e.g. double -> float, int16 -> float
+template <typename From, typename To>
+void convert_samples(const From* in, To* out, std::size_t n) noexcept
+{
+  static_assert(!std::is_same_v<From, char> && !std::is_same_v<To, char>);
+  for(std::size_t i = 0; i < n; ++i)
+    out[i] = static_cast<To>(in[i]);
+}
+
+// Quantised integers to floats, per channel: in * scale + offset
+template <typename T>
+void dequantize_samples(
+    const T* in, const float* scale, const float* offset, float* out, std::size_t n) noexcept
+{
+  static_assert(!std::is_same_v<T, char>);
+  for(std::size_t i = 0; i < n; ++i)
+    out[i] = static_cast<float>(in[i]) * scale[i] + offset[i];
+}
+
+// Floats to quantised integers, per channel: (in - offset) / scale, rounded to the
+// nearest integer and saturated to the symmetric range of T. NaN, which the clamp
+// lets through and which cannot be cast, is sent as the offset.
+template <typename T>
+void quantize_samples(
+    const float* in, const float* scale, const float* offset, T* out, std::size_t n) noexcept
+{
+  static_assert(!std::is_same_v<T, char>);
+  constexpr float hi = static_cast<float>(std::numeric_limits<T>::max());
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float q = std::clamp((in[i] - offset[i]) / scale[i], -hi, hi);
+    q = q == q ? q : 0.f;
+    out[i] = static_cast<T>(q + (q < 0.f ? -0.5f : 0.5f));
+  }
+}
+
+// Clamps to per-channel bounds; unbounded channels use -inf / +inf.
+// NaN goes through: float streams carry it as a missing sample.
+inline void clamp_samples(
+    const float* in, const float* min, const float* max, float* out, std::size_t n) noexcept
+{
+  for(std::size_t i = 0; i < n; ++i)
+    out[i] = std::min(std::max(in[i], min[i]), max[i]);
+}
+
+// Linear interpolation between two frames, w in [0, 1]
+template <typename T>
+void interpolate_samples(const T* a, const T* b, float w, float* out, std::size_t n) noexcept
+{
+  static_assert(!std::is_same_v<T, char>);
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    const float va = static_cast<float>(a[i]);
+    const float vb = static_cast<float>(b[i]);
+    out[i] = va + (vb - va) * w;
+  }
+}
+
+}
@@ -1,7 +1,10 @@
 #include "lsl_protocol.hpp"
 
 #include "lsl_context.hpp"
+#include "lsl_kernels.hpp"
 
+#include <ossia/detail/algorithms.hpp>
+#include <ossia/network/base/osc_address.hpp>
 #include <ossia/network/base/parameter_data.hpp>
 #include <ossia/network/common/value_bounding.hpp>
 #include <ossia/network/dataspace/dataspace_visitors.hpp>
@@ -9,14 +12,81 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <future>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 
 namespace lsl_protocol
 {
 
+namespace
+{
+// Full precision text for the numbers written in stream descriptions
+std::string format_double(double v)
+{
+  std::ostringstream ss;
+  ss << std::setprecision(std::numeric_limits<double>::max_digits10) << v;
+  return ss.str();
+}
+
+// Bounds on the period of the aligned frames
+constexpr double min_alignment_rate = 1.;
+constexpr double max_alignment_rate = 1000.;
+
+// Scheduling bounds for the inlet polling periods
+constexpr std::chrono::microseconds min_poll_interval{1000};
+constexpr std::chrono::microseconds max_regular_poll_interval{10000};
+constexpr std::chrono::microseconds max_idle_regular_interval{100000};
+constexpr std::chrono::microseconds max_idle_irregular_interval{20000};
+
+// Timestamps are published as [seconds, remainder]: whole seconds since the epoch, and
+// the remainder in [0, 1). A single float would lose the millisecond after about an
+// hour, the remainder keeps sub-microsecond precision. The timestamp parameters get
+// them as a vec2f, which does not allocate; seconds stay exact for about 190 days.
+void append_timestamp(std::vector<ossia::value>& values, double time)
+{
+  const double seconds = std::floor(time);
+  values.push_back(static_cast<int>(seconds));
+  values.push_back(static_cast<float>(time - seconds));
+}
+
+ossia::vec2f timestamp_value(double time)
+{
+  const double seconds = std::floor(time);
+  return {static_cast<float>(seconds), static_cast<float>(time - seconds)};
+}
+
+// Period of the telemetry published under the _stats nodes
+constexpr std::chrono::seconds stats_interval{1};
+
+ossia::net::parameter_base* create_stats_parameter(
+    ossia::net::node_base& parent, const std::string& name, ossia::val_type type,
+    const std::string& description)
+{
+  auto node = parent.create_child(name);
+  auto param = node->create_parameter(type);
+  param->set_access(ossia::access_mode::GET);
+  ossia::net::set_description(*node, description);
+  return param;
+}
+
+// Counts of each bucket of the histogram since the previous publication
+ossia::value histogram_value(lsl_duration_histogram& histogram)
+{
+  std::vector<ossia::value> counts;
+  counts.reserve(lsl_duration_histogram::bucket_count);
+  histogram.take([&](std::uint64_t n) { counts.push_back(static_cast<int>(n)); });
+  return counts;
+}
+
+
+}
+
 lsl_protocol::lsl_protocol(std::shared_ptr<lsl_context> lsl)
-    : protocol_base{flags{}}
+    : protocol_base{flags{SupportsMultiplex}}
     , m_context{lsl}
 {
 }
@@ -29,51 +99,148 @@ lsl_protocol::~lsl_protocol()
 bool lsl_protocol::push(const ossia::net::parameter_base& param, const ossia::value& v)
 {
   // Find which outlet this parameter belongs to
-  std::lock_guard<std::mutex> lock(m_outlets_mutex);
+  std::shared_lock<std::shared_mutex> lock(m_outlet_index_mutex);
+
+  auto it = m_outlet_index.find(&param);
+  if (it == m_outlet_index.end())
+    return false;
+
+  auto& [outlet, channel_index] = it->second;
+
+  // Stage the write, the outlet thread encodes and sends it
+  if (!stage_write(*outlet, channel_index, lsl::local_clock(), v, true))
+    return false;
+
+  wake_outlet_thread();
+  return true;
+}
+
+bool lsl_protocol::push_raw(const ossia::net::full_parameter_data& data)
+{
+  std::shared_lock<std::shared_mutex> lock(m_outlet_index_mutex);
+
+  auto it = m_outlet_address_index.find(data.address);
+  if (it == m_outlet_address_index.end())
+    return false;
+
+  auto& [outlet, channel_index] = it->second;
+  if (!stage_write(*outlet, channel_index, lsl::local_clock(), data.value(), true))
+    return false;
+
+  wake_outlet_thread();
+  return true;
+}
+
+bool lsl_protocol::push_bundle(const std::vector<const ossia::net::parameter_base*>& params)
+{
+  return stage_writes(params, [this](const ossia::net::parameter_base* param)
+                                  -> std::pair<const outlet_slot*, ossia::value> {
+    auto it = m_outlet_index.find(param);
+    if (it == m_outlet_index.end())
+      return {};
+    return {&it->second, param->value()};
+  });
+}
+
+bool lsl_protocol::push_raw_bundle(const std::vector<ossia::net::full_parameter_data>& data)
+{
+  return stage_writes(data, [this](const ossia::net::full_parameter_data& d)
+                                -> std::pair<const outlet_slot*, ossia::value> {
+    auto it = m_outlet_address_index.find(d.address);
+    if (it == m_outlet_address_index.end())
+      return {};
+    return {&it->second, d.value()};
+  });
+}
+
+// Stages a batch of writes under a single index lock. Only the last write
+// to each outlet commits, so every touched outlet sends exactly one sample.
+template <typename Writes, typename Resolve>
+bool lsl_protocol::stage_writes(const Writes& writes, Resolve&& resolve)
+{
+  thread_local std::vector<std::pair<const outlet_slot*, ossia::value>> resolved;
+  thread_local std::vector<const outlet_data*> committed;
+  thread_local std::vector<bool> commit;
+  resolved.clear();
+  committed.clear();
 
-  for (auto& [uid, outlet] : m_active_outlets)
+  std::shared_lock<std::shared_mutex> lock(m_outlet_index_mutex);
+  for (const auto& w : writes)
   {
-    auto it = std::find(
-        outlet.parameters.begin(), outlet.parameters.end(), &param);
-    if (it != outlet.parameters.end())
-    {
-      size_t channel_index = std::distance(outlet.parameters.begin(), it);
+    auto r = resolve(w);
+    if (r.first)
+      resolved.push_back(std::move(r));
+  }
+  if (resolved.empty())
+    return false;
 
-      // Update the stored value for this channel
-      if (channel_index < outlet.current_values.size())
-      {
-        outlet.current_values[channel_index] = v;
-        
-        // Send the complete current measurement using the existing typed push
-        if (outlet.outlet)
-        {
-          try
-          {
-            push_typed_sample(uid, outlet.current_values);
-            return true;
-          }
-          catch (const std::exception& e)
-          {
-            ossia::logger().error("LSL push error: {}", e.what());
-          }
-        }
-      }
+  // Walk backwards to find the last write of each outlet
+  const double timestamp = lsl::local_clock();
+  commit.assign(resolved.size(), false);
+  for (std::size_t i = resolved.size(); i-- > 0;)
+  {
+    const auto* outlet = resolved[i].first->outlet;
+    if (std::find(committed.begin(), committed.end(), outlet) == committed.end())
+    {
+      committed.push_back(outlet);
+      commit[i] = true;
     }
   }
 
-  return false;
+  bool ok = true;
+  for (std::size_t i = 0; i < resolved.size(); ++i)
+  {
+    auto& [slot, value] = resolved[i];
+    ok &= stage_write(*slot->outlet, slot->channel, timestamp, std::move(value), commit[i]);
+  }
+
+  wake_outlet_thread();
+  return ok;
 }
 
-bool lsl_protocol::push_raw(const ossia::net::full_parameter_data& data)
+// Fills a slot of the staging ring in place. Numeric outlets only store a float,
+// the value is only copied for the other ones. Fails when the outlet thread is
+// a whole ring behind.
+template <typename Value>
+bool lsl_protocol::stage_write(
+    outlet_data& outlet, std::size_t channel, double timestamp, Value&& value, bool commit)
+{
+  return outlet.staging.push([&](lsl_staged_write& w) {
+    w.channel = channel;
+    w.timestamp = timestamp;
+    w.commit = commit;
+    if (outlet.float_samples)
+      w.number = ossia::convert<float>(value);
+    else
+      w.value = std::forward<Value>(value);
+  });
+}
+
+void lsl_protocol::wake_outlet_thread()
 {
-  // Forward to regular push
-  return false; // FIXME push(data.address, data.value);
+  m_outlet_pending = true;
+  if (m_outlet_thread_sleeping)
+  {
+    std::lock_guard<std::mutex> wakeup_lock(m_outlet_wakeup_mutex);
+    m_outlets_cv.notify_one();
+  }
 }
 
 bool lsl_protocol::pull(ossia::net::parameter_base& param)
 {
   // LSL is push-based, pulling will return the last known value
-  // The actual values are updated in the streaming thread
+  // The actual values are updated in the streaming thread.
+  // Batch parameters get the frames queued since the last drain of their inlet.
+  std::shared_ptr<inlet_data> inlet;
+  {
+    std::lock_guard<std::mutex> lock(m_inlets_mutex);
+    auto it = m_batch_index.find(&param);
+    if (it == m_batch_index.end())
+      return true;
+    inlet = it->second;
+  }
+
+  drain_batch(*inlet);
   return true;
 }
 
@@ -85,7 +252,23 @@ bool lsl_protocol::observe(ossia::net::parameter_base& param, bool enable)
 
 bool lsl_protocol::update(ossia::net::node_base& node_base)
 {
-  // Nothing to update - LSL is push-based
+  // LSL is push-based: the only thing to update are the per-channel
+  // parameters of frame-mode streams, which are created on demand
+  if (!m_device)
+    return true;
+
+  const bool is_root = &node_base == &m_device->get_root_node();
+  std::lock_guard<std::mutex> lock(m_inlets_mutex);
+  for (auto& [uid, inlet] : m_active_inlets)
+  {
+    if (!inlet->options.frame_mode || !inlet->parameters.empty())
+      continue;
+    if (is_root || &node_base == inlet->sensor)
+    {
+      std::lock_guard<std::mutex> inlet_lock(inlet->mutex);
+      create_channel_parameters(*inlet);
+    }
+  }
   return true;
 }
 
@@ -102,18 +285,71 @@ void lsl_protocol::start_discovery()
     return;
   }
 
-  // Start the streaming thread
+  if (m_running)
+    return;
+
+  // Only the streams matching the filter are discovered
+  m_discovery_predicate = lsl_context::make_predicate(m_stream_filter);
+  m_context->acquire_discovery(m_discovery_predicate);
+  m_discovery_acquired = true;
+
+  // Start the inlet workers
+  std::size_t count = m_worker_count;
+  if (count == 0)
+    count = std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+
   m_running = true;
-  m_streaming_thread = std::thread(&lsl_protocol::streaming_thread_function, this);
+  m_workers.clear();
+  for (std::size_t i = 0; i < count; ++i)
+    m_workers.push_back(std::make_unique<inlet_worker>());
+  for (std::size_t i = 0; i < count; ++i)
+    m_workers[i]->thread = std::thread(&lsl_protocol::worker_thread_function, this, i);
+
+  // Inlets subscribed before the workers existed
+  {
+    std::lock_guard<std::mutex> lock(m_inlets_mutex);
+    for (auto& [uid, inlet] : m_active_inlets)
+      schedule_inlet(inlet);
+  }
+
+  if (m_alignment.rate > 0. && !m_alignment.streams.empty())
+  {
+    create_alignment_nodes();
+    m_alignment_thread = std::thread(&lsl_protocol::alignment_thread_function, this);
+  }
+
+  m_stats_thread = std::thread(&lsl_protocol::stats_thread_function, this);
 }
 
 void lsl_protocol::stop()
 {
-  // Stop the streaming thread
+  // Stop the inlet workers
   m_running = false;
-  if (m_streaming_thread.joinable())
+  for (auto& worker : m_workers)
+  {
+    // Taking the lock ensures the worker is either waiting or will see m_running
+    { std::lock_guard<std::mutex> lock(worker->mutex); }
+    worker->cv.notify_all();
+  }
+  for (auto& worker : m_workers)
+  {
+    if (worker->thread.joinable())
+      worker->thread.join();
+  }
+  m_workers.clear();
+
+  if (m_alignment_thread.joinable())
+    m_alignment_thread.join();
+
+  { std::lock_guard<std::mutex> lock(m_stats_mutex); }
+  m_stats_cv.notify_all();
+  if (m_stats_thread.joinable())
+    m_stats_thread.join();
+
+  if (m_discovery_acquired)
   {
-    m_streaming_thread.join();
+    m_context->release_discovery(m_discovery_predicate);
+    m_discovery_acquired = false;
   }
   
   // Clean up all inlets
@@ -121,83 +357,181 @@ void lsl_protocol::stop()
     std::lock_guard<std::mutex> lock(m_inlets_mutex);
     for (auto& [uid, inlet] : m_active_inlets)
     {
-      if(inlet.sensor)
-        this->m_device->get_root_node().remove_child(*inlet.sensor);
+      std::lock_guard<std::mutex> inlet_lock(inlet->mutex);
+      inlet->active = false;
+      if(inlet->sensor)
+        this->m_device->get_root_node().remove_child(*inlet->sensor);
     }
     m_active_inlets.clear();
+    m_batch_index.clear();
   }
   
+  // Stop the outlet thread
+  {
+    std::lock_guard<std::mutex> lock(m_outlet_wakeup_mutex);
+    m_outlet_thread_running = false;
+  }
+  m_outlets_cv.notify_all();
+  if (m_outlet_thread.joinable())
+    m_outlet_thread.join();
+
   // Clean up all outlets
   {
     std::lock_guard<std::mutex> lock(m_outlets_mutex);
+    {
+      std::unique_lock<std::shared_mutex> index_lock(m_outlet_index_mutex);
+      m_outlet_index.clear();
+      m_outlet_address_index.clear();
+      m_outlet_uid_index.clear();
+    }
     m_active_outlets.clear();
   }
 }
 
-bool lsl_protocol::subscribe_to_stream(const std::string& stream_uid)
+std::vector<lsl_stream_data> lsl_protocol::get_available_streams() const
+{
+  std::vector<lsl_stream_data> streams;
+  if (!m_context)
+    return streams;
+
+  auto snapshot = m_context->get_current_streams(m_discovery_predicate);
+  streams.reserve(snapshot->size());
+  for (const auto& [uid, stream] : *snapshot)
+    streams.push_back(stream);
+  return streams;
+}
+
+bool lsl_protocol::subscribe_to_stream(
+    const std::string& stream_uid, const lsl_inlet_options& options)
 {
-  std::lock_guard<std::mutex> lock(m_inlets_mutex);
-  
-  // Check if already subscribed
-  if (m_active_inlets.find(stream_uid) != m_active_inlets.end())
   {
-    ossia::logger().warn("Already subscribed to stream: {}", stream_uid);
-    return true;
+    std::lock_guard<std::mutex> lock(m_inlets_mutex);
+
+    // Check if already subscribed
+    if (m_active_inlets.find(stream_uid) != m_active_inlets.end())
+    {
+      ossia::logger().warn("Already subscribed to stream: {}", stream_uid);
+      return true;
+    }
   }
-  
-  // Get stream info from context
-  auto streams = m_context->get_current_streams();
-  auto it = streams.find(stream_uid);
-  if (it == streams.end())
+
+  return activate_inlet(open_inlet(stream_uid, options));
+}
+
+void lsl_protocol::subscribe_to_streams(const std::vector<stream_subscription>& streams)
+{
+  std::vector<std::future<std::shared_ptr<inlet_data>>> pending;
+  pending.reserve(streams.size());
+  for (const auto& [uid, options] : streams)
   {
-    ossia::logger().error("Stream not found: {}", stream_uid);
-    return false;
+    pending.push_back(std::async(
+        std::launch::async, [this, uid, options] { return open_inlet(uid, options); }));
   }
-  
-  const auto& stream_info = it->second;
-  
-  try
+
+  for (auto& inlet : pending)
+    activate_inlet(inlet.get());
+}
+
+std::shared_ptr<lsl_protocol::inlet_data>
+lsl_protocol::open_inlet(const std::string& stream_uid, const lsl_inlet_options& options)
+{
+  // Aligned streams keep the frames of the alignment delay, and of two polling
+  // periods for the frames still to be pulled
+  lsl_buffer_options buffering = options.buffering;
+  if (m_alignment.rate > 0. && ossia::contains(m_alignment.streams, stream_uid))
   {
-    // Create inlet
-    inlet_data inlet;
-    inlet.stream_info = stream_info;
-    
-    // Resolve the stream by UID
-    std::vector<lsl::stream_info> results = lsl::resolve_stream("uid", stream_uid, 1, 2.0);
-    if (results.empty())
+    const double polling
+        = 2. * std::chrono::duration<double>(max_regular_poll_interval).count();
+    buffering.history = std::max(buffering.history, m_alignment.delay + polling);
+  }
+
+  // Devices subscribed to the same stream share the connection and the pulled samples
+  auto shared = m_context->acquire_inlet(stream_uid, buffering);
+  if (!shared)
+    return {};
+
+  auto inlet_ptr = std::make_shared<inlet_data>();
+  auto& inlet = *inlet_ptr;
+  inlet.shared = shared;
+  inlet.stream_info = *shared->stream;
+  inlet.options = options;
+  inlet.clock_epoch = m_context->clock_epoch();
+  inlet.last_offset = shared->clock_offset;
+  inlet.last_samples.resize(inlet.stream_info.channel_count);
+
+  const auto& channels = inlet.stream_info.channels;
+  if (channels.size() == std::size_t(inlet.stream_info.channel_count)
+      && std::any_of(channels.begin(), channels.end(), [](const auto& c) { return c.quantized; }))
+  {
+    inlet.quantized = true;
+    for (const auto& channel : channels)
     {
-      ossia::logger().error("Failed to resolve stream: {}", stream_uid);
-      return false;
+      inlet.scale.push_back(static_cast<float>(channel.scale));
+      inlet.offset.push_back(static_cast<float>(channel.offset));
     }
-
-    inlet.inlet = std::make_unique<lsl::stream_inlet>(results[0]);
-    inlet.last_samples.resize(stream_info.channel_count);
-    inlet.last_update = std::chrono::steady_clock::now();
-    
-    // Create node hierarchy
-    m_active_inlets[stream_uid] = std::move(inlet);
-    create_node_hierarchy_for_stream(stream_info);
-    return true;
   }
-  catch (const std::exception& e)
+
+  const auto format = inlet.stream_info.channel_format;
+  inlet.float_samples = format == lsl::cf_float32 || format == lsl::cf_double64
+                        || (inlet.quantized && format != lsl::cf_string);
+  if (inlet.float_samples)
+    inlet.decoded.resize(inlet.stream_info.channel_count);
+  inlet.last_update = std::chrono::steady_clock::now();
   {
-    ossia::logger().error("Failed to subscribe to stream {}: {}", 
-                                   stream_uid, e.what());
-    return false;
+    // Start with the samples arriving from now on
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    inlet.cursor = shared->head;
   }
+  inlet.pending_timestamps.resize(shared->chunk_frames);
+
+  dispatch_channel_format(
+      inlet.stream_info.channel_format, [&]<lsl::channel_format_t F>(lsl_format_constant<F>) {
+        using sample_type = typename lsl_format_traits<F>::sample_type;
+        inlet.pending.emplace<std::vector<sample_type>>(
+            shared->chunk_frames * inlet.stream_info.channel_count);
+
+        // Marker streams never coalesce: every event is delivered
+        if (inlet.stream_info.nominal_srate <= 0.)
+          inlet.decode = &lsl_protocol::drain_events<F>;
+        else
+          inlet.decode = &lsl_protocol::drain_inlet<F>;
+      });
+  inlet.poll_interval = next_poll_interval(inlet, 1);
+  return inlet_ptr;
+}
+
+bool lsl_protocol::activate_inlet(std::shared_ptr<inlet_data> inlet)
+{
+  if (!inlet)
+    return false;
+
+  std::lock_guard<std::mutex> lock(m_inlets_mutex);
+  const auto& uid = inlet->stream_info.uid;
+  if (m_active_inlets.find(uid) != m_active_inlets.end())
+    return true;
+
+  // Create node hierarchy
+  create_node_hierarchy_for_stream(*inlet);
+  m_active_inlets[uid] = inlet;
+  if (inlet->batch_parameter)
+    m_batch_index[inlet->batch_parameter] = inlet;
+
+  schedule_inlet(std::move(inlet));
+  return true;
 }
 
 std::string lsl_protocol::create_outlet(
     const lsl::stream_info& info,
-    const std::vector<lsl_channel_info>& channel_info)
+    const std::vector<lsl_channel_info>& channel_info,
+    const lsl_outlet_options& options)
 {
   std::lock_guard<std::mutex> lock(m_outlets_mutex);
   
   try
   {
-    // Create outlet
-    outlet_data outlet_data;
-    outlet_data.outlet = std::make_unique<lsl::stream_outlet>(info);
+    auto outlet_ptr = std::make_unique<outlet_data>();
+    auto& outlet_data = *outlet_ptr;
+    outlet_data.coalesce_window = options.coalesce_window;
     
     // Get the UID
     std::string uid = info.uid();
@@ -226,6 +560,103 @@ std::string lsl_protocol::create_outlet(
       outlet_data.channel_info = channel_info;
       outlet_data.current_values.resize(channel_info.size(), ossia::value{0.0f});
     }
+
+    // Quantised outlets: the channel descriptions carry the scale and offset
+    lsl::stream_info outlet_info = info;
+    const bool quantize = options.quantize
+                          && (outlet_data.format == lsl::cf_int8
+                              || outlet_data.format == lsl::cf_int16);
+    if (quantize)
+    {
+      const double levels = outlet_data.format == lsl::cf_int8 ? 127. : 32767.;
+      auto channels = outlet_info.desc().append_child("channels");
+      for (auto& ch_info : outlet_data.channel_info)
+      {
+        double min = -1., max = 1.;
+        if (ch_info.domain != ossia::domain{})
+        {
+          min = ossia::convert<double>(ch_info.domain.get_min());
+          max = ossia::convert<double>(ch_info.domain.get_max());
+        }
+        if (!(min < max))
+        {
+          // Clamping to an empty range would send a constant
+          ossia::logger().warn(
+              "Empty range [{}, {}] for channel {} of outlet {}, quantizing [-1, 1]", min,
+              max, ch_info.name, info.name());
+          min = -1.;
+          max = 1.;
+          ch_info.domain = ossia::make_domain(-1.f, 1.f);
+        }
+        ch_info.quantized = true;
+        ch_info.offset = (min + max) / 2.;
+        ch_info.scale = (max - min) / (2. * levels);
+        ch_info.ossia_type = ossia::val_type::FLOAT;
+        outlet_data.scale.push_back(static_cast<float>(ch_info.scale));
+        outlet_data.offset.push_back(static_cast<float>(ch_info.offset));
+
+        auto channel = channels.append_child("channel");
+        channel.append_child_value("label", ch_info.name);
+        if (!ch_info.unit.empty())
+          channel.append_child_value("unit", ch_info.unit);
+        auto range = channel.append_child("range");
+        range.append_child_value("minimum", format_double(min));
+        range.append_child_value("maximum", format_double(max));
+        auto quantization = channel.append_child("quantization");
+        quantization.append_child_value("scale", format_double(ch_info.scale));
+        quantization.append_child_value("offset", format_double(ch_info.offset));
+      }
+    }
+    outlet_data.outlet = std::make_unique<lsl::stream_outlet>(outlet_info);
+
+    // Float, double and quantised outlets keep their sample as an array of floats
+    outlet_data.float_samples = quantize || outlet_data.format == lsl::cf_float32
+                                || outlet_data.format == lsl::cf_double64;
+    if (outlet_data.float_samples)
+    {
+      const std::size_t channels = outlet_data.channel_info.size();
+      outlet_data.current_samples.resize(channels);
+      outlet_data.min.resize(channels, -std::numeric_limits<float>::infinity());
+      outlet_data.max.resize(channels, std::numeric_limits<float>::infinity());
+      for (std::size_t i = 0; i < channels; ++i)
+      {
+        const auto& domain = outlet_data.channel_info[i].domain;
+        if (domain == ossia::domain{})
+          continue;
+        const float min = ossia::convert<float>(domain.get_min());
+        const float max = ossia::convert<float>(domain.get_max());
+        if (!(min < max))
+        {
+          ossia::logger().warn(
+              "Empty range [{}, {}] for channel {} of outlet {}, not clamped", min, max,
+              outlet_data.channel_info[i].name, info.name());
+          continue;
+        }
+        outlet_data.min[i] = min;
+        outlet_data.max[i] = max;
+        outlet_data.clamp = true;
+      }
+    }
+
+    const bool supported = dispatch_channel_format(
+        outlet_data.format, [&]<lsl::channel_format_t F>(lsl_format_constant<F>) {
+          using sample_type = typename lsl_format_traits<F>::sample_type;
+          outlet_data.chunk.emplace<std::vector<sample_type>>();
+          outlet_data.append_frame = &lsl_protocol::append_outlet_frame<F>;
+          if constexpr (std::is_floating_point_v<sample_type>)
+          {
+            outlet_data.append_frame = &lsl_protocol::append_float_frame<F>;
+          }
+          else if constexpr (std::is_integral_v<sample_type>)
+          {
+            if (quantize)
+              outlet_data.append_frame = &lsl_protocol::append_quantized_frame<F>;
+          }
+          outlet_data.send_chunk = &lsl_protocol::send_outlet_chunk<F>;
+        });
+    if (!supported)
+      ossia::logger().warn(
+          "Unsupported LSL channel format: {}", static_cast<int>(outlet_data.format));
     
     // Create node hierarchy for the outlet
     if (m_device)
@@ -253,9 +684,28 @@ std::string lsl_protocol::create_outlet(
         
         outlet_data.parameters.push_back(param);
       }
+
+      create_outlet_stats_nodes(outlet_data, *outlet_node);
+    }
+
+    // Index the channels
+    {
+      std::unique_lock<std::shared_mutex> index_lock(m_outlet_index_mutex);
+      for (std::size_t i = 0; i < outlet_data.parameters.size(); ++i)
+      {
+        auto* param = outlet_data.parameters[i];
+        m_outlet_index[param] = {&outlet_data, i};
+        m_outlet_address_index[ossia::net::osc_parameter_string(*param)] = {&outlet_data, i};
+      }
+      m_outlet_uid_index[uid] = &outlet_data;
+    }
+    m_active_outlets[uid] = std::move(outlet_ptr);
+
+    if (!m_outlet_thread_running)
+    {
+      m_outlet_thread_running = true;
+      m_outlet_thread = std::thread(&lsl_protocol::outlet_thread_function, this);
     }
-    
-    m_active_outlets[uid] = std::move(outlet_data);
     
     ossia::logger().info("Created outlet: {} ({})", info.name(), uid);
     return uid;
@@ -269,11 +719,22 @@ std::string lsl_protocol::create_outlet(
 
 void lsl_protocol::destroy_outlet(const std::string& outlet_uid)
 {
+  std::lock_guard<std::mutex> stats_lock(m_outlet_stats_mutex);
   std::lock_guard<std::mutex> lock(m_outlets_mutex);
   
   auto it = m_active_outlets.find(outlet_uid);
   if (it != m_active_outlets.end())
   {
+    {
+      std::unique_lock<std::shared_mutex> index_lock(m_outlet_index_mutex);
+      for (auto* param : it->second->parameters)
+      {
+        m_outlet_index.erase(param);
+        m_outlet_address_index.erase(ossia::net::osc_parameter_string(*param));
+      }
+      m_outlet_uid_index.erase(outlet_uid);
+    }
+
     // Remove node hierarchy
     if (m_device)
     {
@@ -292,11 +753,13 @@ void lsl_protocol::destroy_outlet(const std::string& outlet_uid)
 void lsl_protocol::push_typed_sample(const std::string& outlet_uid, 
                                     const std::vector<ossia::value>& values)
 {
-  auto it = m_active_outlets.find(outlet_uid);
-  if (it == m_active_outlets.end() || !it->second.outlet)
+  std::shared_lock<std::shared_mutex> lock(m_outlet_index_mutex);
+
+  auto it = m_outlet_uid_index.find(outlet_uid);
+  if (it == m_outlet_uid_index.end())
     return;
     
-  auto& outlet = it->second;
+  auto& outlet = *it->second;
   
   if (values.size() != outlet.channel_info.size())
   {
@@ -305,202 +768,941 @@ void lsl_protocol::push_typed_sample(const std::string& outlet_uid,
         outlet.channel_info.size(), values.size());
     return;
   }
-  
+
+  // Staged as one write per channel, the last one completes the sample
+  const double timestamp = lsl::local_clock();
+  for (std::size_t i = 0; i < values.size(); ++i)
+  {
+    if (!stage_write(outlet, i, timestamp, values[i], i + 1 == values.size()))
+      break;
+  }
+
+  wake_outlet_thread();
+}
+
+template <lsl::channel_format_t Format>
+void lsl_protocol::append_outlet_frame(outlet_data& outlet, double timestamp)
+{
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  auto& chunk = *std::get_if<std::vector<sample_type>>(&outlet.chunk);
+
+  for (const auto& v : outlet.current_values)
+    chunk.push_back(lsl_format_traits<Format>::from_value(v));
+  outlet.chunk_timestamps.push_back(timestamp);
+}
+
+template <lsl::channel_format_t Format>
+void lsl_protocol::append_float_frame(outlet_data& outlet, double timestamp)
+{
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  auto& chunk = *std::get_if<std::vector<sample_type>>(&outlet.chunk);
+
+  const std::size_t channels = outlet.current_samples.size();
+  float* samples = outlet.current_samples.data();
+  if (outlet.clamp)
+    clamp_samples(samples, outlet.min.data(), outlet.max.data(), samples, channels);
+
+  const std::size_t start = chunk.size();
+  chunk.resize(start + channels);
+  convert_samples(samples, kernel_samples(chunk.data() + start), channels);
+  outlet.chunk_timestamps.push_back(timestamp);
+}
+
+template <lsl::channel_format_t Format>
+void lsl_protocol::append_quantized_frame(outlet_data& outlet, double timestamp)
+{
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  auto& chunk = *std::get_if<std::vector<sample_type>>(&outlet.chunk);
+
+  const std::size_t channels = outlet.current_samples.size();
+  float* samples = outlet.current_samples.data();
+  if (outlet.clamp)
+    clamp_samples(samples, outlet.min.data(), outlet.max.data(), samples, channels);
+
+  const std::size_t start = chunk.size();
+  chunk.resize(start + channels);
+  quantize_samples(
+      samples, outlet.scale.data(), outlet.offset.data(), kernel_samples(chunk.data() + start),
+      channels);
+  outlet.chunk_timestamps.push_back(timestamp);
+}
+
+template <lsl::channel_format_t Format>
+void lsl_protocol::send_outlet_chunk(outlet_data& outlet)
+{
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  auto& chunk = *std::get_if<std::vector<sample_type>>(&outlet.chunk);
+  if (outlet.chunk_timestamps.empty())
+    return;
+
   try
   {
-    switch (outlet.format)
-    {
-      case lsl::cf_float32:
-      {
-        thread_local std::vector<float> sample;
-        sample.clear();
-        sample.reserve(values.size());
-        for (const auto& v : values)
-          sample.push_back(ossia::convert<float>(v));
-        outlet.outlet->push_sample(sample);
-        break;
-      }
-      case lsl::cf_double64:
-      {
-        thread_local std::vector<double> sample;
-        sample.clear();
-        sample.reserve(values.size());
-        for (const auto& v : values)
-          sample.push_back(ossia::convert<double>(v));
-        outlet.outlet->push_sample(sample);
-        break;
-      }
-      case lsl::cf_int32:
-      {
-        thread_local std::vector<int32_t> sample;
-        sample.clear();
-        sample.reserve(values.size());
-        for (const auto& v : values)
-          sample.push_back(ossia::convert<int>(v));
-        outlet.outlet->push_sample(sample);
-        break;
-      }
-      case lsl::cf_int16:
-      {
-        thread_local std::vector<int16_t> sample;
-        sample.clear();
-        sample.reserve(values.size());
-        for (const auto& v : values)
-          sample.push_back(static_cast<int16_t>(ossia::convert<int>(v)));
-        outlet.outlet->push_sample(sample);
-        break;
-      }
-      case lsl::cf_string:
-      {
-        thread_local std::vector<std::string> sample;
-        sample.clear();
-        sample.reserve(values.size());
-        for (const auto& v : values)
-        {
-          if (v.get_type() == ossia::val_type::STRING)
-            sample.push_back(*v.target<std::string>());
-          else
-            sample.push_back(ossia::convert<std::string>(v));
-        }
-        outlet.outlet->push_sample(sample);
-        break;
-      }
-      default:
-        ossia::logger().warn(
-            "Unsupported LSL channel format: {}",
-            static_cast<int>(outlet.format));
-    }
+    const auto start = std::chrono::steady_clock::now();
+    outlet.outlet->push_chunk_multiplexed(
+        chunk.data(), outlet.chunk_timestamps.data(), chunk.size());
+    outlet.stats.push_time.record(std::chrono::steady_clock::now() - start);
+    outlet.stats.frames.fetch_add(
+        outlet.chunk_timestamps.size(), std::memory_order_relaxed);
   }
   catch (const std::exception& e)
   {
     ossia::logger().error("Failed to push sample: {}", e.what());
   }
+
+  // Keeps the capacity for the next batch
+  chunk.clear();
+  outlet.chunk_timestamps.clear();
 }
 
-void lsl_protocol::streaming_thread_function()
+void lsl_protocol::process_outlet(
+    outlet_data& outlet, std::chrono::steady_clock::time_point now)
 {
-  while (m_running)
+  if (!outlet.outlet || !outlet.append_frame)
   {
-    if (m_streaming_enabled)
+    while (outlet.staging.pop([](lsl_staged_write&) {}))
+      ;
+    return;
+  }
+
+  const bool coalesce = outlet.coalesce_window.count() > 0;
+
+  // Apply the staged writes; without coalescing each write makes one sample
+  const auto apply = [&](lsl_staged_write& w) {
+    if (w.channel >= outlet.current_values.size())
+      return;
+
+    // Numeric outlets were unboxed by the writer, and are converted frame by frame
+    if (outlet.float_samples)
+      outlet.current_samples[w.channel] = w.number;
+    else
+      outlet.current_values[w.channel] = std::move(w.value);
+    if (coalesce)
     {
-      std::lock_guard<std::mutex> lock(m_inlets_mutex);
-      
-      for (auto& [uid, inlet] : m_active_inlets)
+      if (!outlet.dirty)
       {
-        process_inlet_samples(inlet);
+        outlet.dirty = true;
+        outlet.flush_due = now + outlet.coalesce_window;
       }
+      outlet.pending_timestamp = w.timestamp;
+    }
+    else if (w.commit)
+    {
+      (this->*outlet.append_frame)(outlet, w.timestamp);
     }
+  };
+  while (outlet.staging.pop(apply))
+    ;
 
-    // Small sleep to prevent busy waiting
-    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  if (coalesce && outlet.dirty && outlet.flush_due <= now)
+  {
+    outlet.dirty = false;
+    (this->*outlet.append_frame)(outlet, outlet.pending_timestamp);
   }
+
+  // Everything gathered in this pass goes out in a single call
+  (this->*outlet.send_chunk)(outlet);
 }
 
-void lsl_protocol::process_inlet_samples(inlet_data& inlet)
+void lsl_protocol::outlet_thread_function()
 {
-  if (!inlet.inlet || inlet.parameters.empty())
-    return;
+  using clock = std::chrono::steady_clock;
 
-  try
+  while (m_outlet_thread_running)
   {
-    switch(inlet.stream_info.channel_format)
+    m_outlet_pending = false;
+
+    // Send the staged writes, and find the next coalesced sample due
+    auto next = clock::time_point::max();
     {
-      case lsl::cf_float32: {
-        std::vector<float> sample(inlet.stream_info.channel_count);
-        if(inlet.inlet->pull_sample(sample, 0.0) != 0.0)
-        {
-          for(size_t i = 0; i < sample.size() && i < inlet.parameters.size(); ++i)
-          {
-            if(inlet.parameters[i])
-            {
-              inlet.parameters[i]->push_value(sample[i]);
-              inlet.last_samples[i] = sample[i];
-            }
-          }
-          inlet.last_update = std::chrono::steady_clock::now();
-        }
-        break;
+      std::lock_guard<std::mutex> lock(m_outlets_mutex);
+      const auto now = clock::now();
+      for (auto& [uid, outlet] : m_active_outlets)
+      {
+        process_outlet(*outlet, now);
+        if (outlet->dirty)
+          next = std::min(next, outlet->flush_due);
+      }
+    }
+
+    // Writers only take the wakeup mutex when we are about to sleep;
+    // sleeping is published before checking for pending writes so none is missed.
+    std::unique_lock<std::mutex> lock(m_outlet_wakeup_mutex);
+    m_outlet_thread_sleeping = true;
+    if (!m_outlet_pending && m_outlet_thread_running)
+    {
+      if (next == clock::time_point::max())
+        m_outlets_cv.wait(lock);
+      else
+        m_outlets_cv.wait_until(lock, next);
+    }
+    m_outlet_thread_sleeping = false;
+  }
+}
+
+void lsl_protocol::schedule_inlet(std::shared_ptr<inlet_data> inlet)
+{
+  if (m_workers.empty())
+    return;
+
+  // New inlets are spread round-robin; stealing rebalances them afterwards
+  auto& worker = *m_workers[m_next_worker++ % m_workers.size()];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.schedule.push_back({std::chrono::steady_clock::now(), std::move(inlet)});
+    std::push_heap(worker.schedule.begin(), worker.schedule.end(), std::greater<>{});
+  }
+  worker.cv.notify_one();
+}
+
+std::chrono::steady_clock::duration
+lsl_protocol::next_poll_interval(inlet_data& inlet, std::size_t frames) const
+{
+  using namespace std::chrono;
+  const double srate = inlet.stream_info.nominal_srate;
+
+  // Regular streams are polled about once per sample period,
+  // irregular ones as fast as possible while they produce data
+  microseconds base = min_poll_interval;
+  microseconds max_idle = max_idle_irregular_interval;
+  if(srate > 0.)
+  {
+    base = std::clamp(
+        duration_cast<microseconds>(duration<double>(1. / srate)), min_poll_interval,
+        max_regular_poll_interval);
+    max_idle = max_idle_regular_interval;
+  }
+
+  // Exponential backoff while nothing arrives
+  if(frames > 0 || inlet.poll_interval.count() == 0)
+    return base;
+  return std::min<steady_clock::duration>(inlet.poll_interval * 2, max_idle);
+}
+
+std::shared_ptr<lsl_protocol::inlet_data>
+lsl_protocol::steal_inlet(std::size_t thief, std::chrono::steady_clock::time_point now)
+{
+  const std::size_t n = m_workers.size();
+  for (std::size_t k = 1; k < n; ++k)
+  {
+    auto& victim = *m_workers[(thief + k) % n];
+    std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || victim.schedule.empty())
+      continue;
+    if (victim.schedule.front().due > now)
+      continue;
+
+    std::pop_heap(victim.schedule.begin(), victim.schedule.end(), std::greater<>{});
+    auto inlet = std::move(victim.schedule.back().inlet);
+    victim.schedule.pop_back();
+    return inlet;
+  }
+  return {};
+}
+
+void lsl_protocol::worker_thread_function(std::size_t index)
+{
+  using clock = std::chrono::steady_clock;
+  auto& self = *m_workers[index];
+  const std::size_t n = m_workers.size();
+
+  std::unique_lock<std::mutex> lock(self.mutex);
+  while (m_running)
+  {
+    if (!m_streaming_enabled)
+    {
+      // streaming_enabled is rechecked periodically
+      self.cv.wait_for(lock, max_idle_regular_interval);
+      continue;
+    }
+
+    // Take our own earliest overdue inlet, or else steal one from a busy worker
+    const auto now = clock::now();
+    std::shared_ptr<inlet_data> inlet;
+    if (!self.schedule.empty() && self.schedule.front().due <= now)
+    {
+      std::pop_heap(self.schedule.begin(), self.schedule.end(), std::greater<>{});
+      inlet = std::move(self.schedule.back().inlet);
+      self.schedule.pop_back();
+    }
+    else if (n > 1)
+    {
+      lock.unlock();
+      inlet = steal_inlet(index, now);
+      lock.lock();
+    }
+
+    if (!inlet)
+    {
+      // Sleep until our next inlet is due, a subscription, or a request to steal
+      if (self.schedule.empty())
+      {
+        self.cv.wait_for(lock, max_idle_regular_interval);
+      }
+      else
+      {
+        const auto due = self.schedule.front().due;
+        self.cv.wait_until(lock, due);
+      }
+      continue;
+    }
+
+    lock.unlock();
+    {
+      std::lock_guard<std::mutex> inlet_lock(inlet->mutex);
+      if (inlet->active)
+      {
+        const std::size_t frames = process_inlet_samples(*inlet);
+        inlet->poll_interval = next_poll_interval(*inlet, frames);
       }
-      case lsl::cf_double64: {
-        std::vector<double> sample(inlet.stream_info.channel_count);
-        if(inlet.inlet->pull_sample(sample, 0.0) != 0.0)
+    }
+    lock.lock();
+
+    // Unsubscribed inlets are dropped from the schedule here
+    if (!inlet->active)
+      continue;
+
+    const auto due = now + inlet->poll_interval;
+    self.schedule.push_back({due, std::move(inlet)});
+    std::push_heap(self.schedule.begin(), self.schedule.end(), std::greater<>{});
+
+    // Falling behind: wake up a sibling so that it steals our overdue inlets
+    if (n > 1 && self.schedule.front().due < clock::now())
+      m_workers[(index + 1) % n]->cv.notify_one();
+  }
+}
+
+std::size_t lsl_protocol::process_inlet_samples(inlet_data& inlet)
+{
+  if (!inlet.shared
+      || (inlet.parameters.empty() && !inlet.frame_parameter && !inlet.event_parameter))
+    return 0;
+
+  try
+  {
+    if (inlet.decode)
+      return (this->*inlet.decode)(inlet);
+  }
+  catch (const std::exception& e)
+  {
+    ossia::logger().error("Error processing samples for stream {}: {}", 
+                                   inlet.stream_info.uid, e.what());
+  }
+  return 0;
+}
+
+template <lsl::channel_format_t Format>
+std::pair<std::size_t, bool>
+lsl_protocol::pull_frames(inlet_data& inlet, std::chrono::steady_clock::duration& pulling)
+{
+  auto& shared = *inlet.shared;
+  std::lock_guard<std::mutex> lock(shared.mutex);
+
+  // Frames overwritten before this subscriber could read them are skipped:
+  // pulling never waits for a lagging subscriber
+  if(inlet.cursor < shared.tail())
+  {
+    inlet.stats.dropped.fetch_add(shared.tail() - inlet.cursor, std::memory_order_relaxed);
+    inlet.cursor = shared.tail();
+  }
+
+  // Read what the other subscribers already pulled first
+  bool more = true;
+  if(inlet.cursor == shared.head)
+  {
+    // Irregular streams are mostly idle: check the queue before pulling
+    if(inlet.stream_info.nominal_srate <= 0. && shared.inlet->samples_available() == 0)
+      return {0, false};
+
+    const auto pull_start = std::chrono::steady_clock::now();
+    more = shared.fetch<Format>();
+    const auto pull_time = std::chrono::steady_clock::now() - pull_start;
+    inlet.stats.pull_time.record(pull_time);
+    pulling += pull_time;
+  }
+
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  auto& pending = *std::get_if<std::vector<sample_type>>(&inlet.pending);
+  const std::size_t count
+      = std::min<std::uint64_t>(shared.head - inlet.cursor, shared.chunk_frames);
+  shared.copy_frames<Format>(
+      inlet.cursor, count, pending.data(), inlet.pending_timestamps.data());
+  inlet.cursor += count;
+  return {count, count > 0 && (more || inlet.cursor < shared.head)};
+}
+
+template <lsl::channel_format_t Format, typename OnFrame>
+std::size_t
+lsl_protocol::drain_frames(inlet_data& inlet, OnFrame&& on_frame, bool publish_newest)
+{
+  auto& shared = *inlet.shared;
+  const std::size_t channels = inlet.stream_info.channel_count;
+  if(channels == 0 || shared.capacity == 0)
+    return 0;
+
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  const auto& pending = *std::get_if<std::vector<sample_type>>(&inlet.pending);
+  const auto start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::duration pulling{};
+  const bool batching
+      = inlet.options.delivery == lsl_delivery_policy::batch && inlet.batch_parameter;
+
+  // Empty the whole backlog, a chunk at a time while the chunks come back full
+  std::size_t total_frames = 0;
+  std::size_t last = 0; // Index of the newest frame in pending
+  for(;;)
+  {
+    const auto [count, more] = pull_frames<Format>(inlet, pulling);
+    if(count == 0)
+      break;
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+      const sample_type* frame = pending.data() + i * channels;
+      on_frame(frame, inlet.pending_timestamps[i]);
+      if(batching)
+        queue_batch_frame<Format>(inlet, frame, inlet.pending_timestamps[i]);
+    }
+    total_frames += count;
+    last = count - 1;
+
+    if(!more)
+      break;
+  }
+
+  if(total_frames == 0)
+    return 0;
+
+  if(publish_newest)
+    publish_frame<Format>(
+        inlet, pending.data() + last * channels, inlet.pending_timestamps[last]);
+
+  // The frames of the pass go out as one list, pull only flushes them earlier
+  if(inlet.batch_parameter)
+    drain_batch(inlet);
+
+  // Everything but the pulls went into decoding and publishing the frames
+  const auto now = std::chrono::steady_clock::now();
+  inlet.stats.decode_time.record(now - start - pulling);
+  inlet.stats.frames.fetch_add(total_frames, std::memory_order_relaxed);
+  inlet.stats.latency.store(
+      lsl::local_clock() - inlet.pending_timestamps[last] - shared.correction(),
+      std::memory_order_relaxed);
+  inlet.last_update = now;
+  return total_frames;
+}
+
+template <lsl::channel_format_t Format>
+std::size_t lsl_protocol::drain_inlet(inlet_data& inlet)
+{
+  // Unless every frame is published, only the newest one of the pass is
+  const bool every_frame = inlet.options.delivery == lsl_delivery_policy::every_frame;
+  return drain_frames<Format>(
+      inlet,
+      [&](const typename lsl_format_traits<Format>::sample_type* frame, double timestamp) {
+        if(every_frame)
+          publish_frame<Format>(inlet, frame, timestamp);
+      },
+      !every_frame);
+}
+
+template <lsl::channel_format_t Format>
+std::size_t lsl_protocol::drain_events(inlet_data& inlet)
+{
+  // Each event is published on its own whatever the delivery policy
+  return drain_frames<Format>(
+      inlet,
+      [&](const typename lsl_format_traits<Format>::sample_type* frame, double timestamp) {
+        publish_event<Format>(inlet, frame, timestamp);
+      },
+      false);
+}
+
+template <lsl::channel_format_t Format>
+void lsl_protocol::publish_event(
+    inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame,
+    double timestamp)
+{
+  const std::size_t channels = inlet.stream_info.channel_count;
+  const double time = timestamp + inlet.shared->correction() - inlet.clock_epoch;
+
+  if (inlet.timestamp_parameter)
+    inlet.timestamp_parameter->push_value(timestamp_value(time));
+
+  // The samples are copied once out of the shared ring, then moved along
+  std::vector<ossia::value> event;
+  event.reserve(channels + 2);
+  append_timestamp(event, time);
+  for (std::size_t i = 0; i < channels; ++i)
+    event.push_back(channel_value<Format>(inlet, frame, i));
+
+  const std::size_t n = std::min<std::size_t>(channels, inlet.parameters.size());
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (inlet.parameters[i])
+      inlet.parameters[i]->push_value(event[i + 2]);
+  }
+
+  if (inlet.frame_parameter)
+    publish_frame_value<Format>(inlet, frame);
+
+  if (inlet.event_parameter)
+    inlet.event_parameter->push_value(std::move(event));
+}
+
+template <lsl::channel_format_t Format>
+void lsl_protocol::publish_frame(
+    inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame,
+    double timestamp)
+{
+  // The timestamp comes first so that it is current when the samples are observed
+  const double offset = inlet.shared->clock_offset;
+  if (inlet.offset_parameter && offset != inlet.last_offset)
+  {
+    inlet.offset_parameter->push_value(static_cast<float>(offset));
+    inlet.last_offset = offset;
+  }
+  if (inlet.timestamp_parameter)
+    inlet.timestamp_parameter->push_value(
+        timestamp_value(timestamp + inlet.shared->correction() - inlet.clock_epoch));
+
+  // In frame mode this is empty until the channels have been requested
+  const std::size_t n
+      = std::min<std::size_t>(inlet.stream_info.channel_count, inlet.parameters.size());
+
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  if constexpr (std::is_arithmetic_v<sample_type>)
+  {
+    if (inlet.float_samples)
+    {
+      const float* values = decode_frame<Format>(inlet, frame);
+      if (inlet.frame_parameter)
+        publish_float_frame(inlet, values);
+
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        if(inlet.parameters[i])
         {
-          for(size_t i = 0; i < sample.size() && i < inlet.parameters.size(); ++i)
-          {
-            if(inlet.parameters[i])
-            {
-              inlet.parameters[i]->push_value(sample[i]);
-              inlet.last_samples[i] = (float)sample[i];
-            }
-          }
-          inlet.last_update = std::chrono::steady_clock::now();
+          inlet.parameters[i]->push_value(values[i]);
+          inlet.last_samples[i] = values[i];
         }
-        break;
       }
-      case lsl::cf_int32: {
-        std::vector<int32_t> sample(inlet.stream_info.channel_count);
-        if(inlet.inlet->pull_sample(sample, 0.0) != 0.0)
-        {
-          for(size_t i = 0; i < sample.size() && i < inlet.parameters.size(); ++i)
+      return;
+    }
+  }
+
+  if (inlet.frame_parameter)
+    publish_frame_value<Format>(inlet, frame);
+
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    if(inlet.parameters[i])
+    {
+      auto v = channel_value<Format>(inlet, frame, i);
+      inlet.parameters[i]->push_value(v);
+      inlet.last_samples[i] = std::move(v);
+    }
+  }
+}
+
+template <lsl::channel_format_t Format>
+void lsl_protocol::queue_batch_frame(
+    inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame,
+    double timestamp)
+{
+  const std::size_t channels = inlet.stream_info.channel_count;
+  std::vector<ossia::value> values;
+  values.reserve(channels + 2);
+  append_timestamp(values, timestamp + inlet.shared->correction() - inlet.clock_epoch);
+
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  if constexpr (std::is_arithmetic_v<sample_type>)
+  {
+    if (inlet.float_samples)
+    {
+      const float* decoded = decode_frame<Format>(inlet, frame);
+      values.insert(values.end(), decoded, decoded + channels);
+      inlet.batch.enqueue(ossia::value{std::move(values)});
+      return;
+    }
+  }
+
+  for (std::size_t i = 0; i < channels; ++i)
+    values.push_back(channel_value<Format>(inlet, frame, i));
+  inlet.batch.enqueue(ossia::value{std::move(values)});
+}
+
+void lsl_protocol::drain_batch(inlet_data& inlet)
+{
+  std::lock_guard<std::mutex> lock(inlet.batch_mutex);
+
+  std::vector<ossia::value> frames;
+  frames.reserve(inlet.batch.size_approx());
+  ossia::value frame;
+  while (inlet.batch.try_dequeue(frame))
+    frames.push_back(std::move(frame));
+
+  if (!frames.empty())
+    inlet.batch_parameter->push_value(std::move(frames));
+}
+
+template <lsl::channel_format_t Format>
+ossia::value lsl_protocol::channel_value(
+    const inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame,
+    std::size_t channel)
+{
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  if constexpr (std::is_arithmetic_v<sample_type>)
+  {
+    if (inlet.quantized)
+      return float(kernel_samples(frame)[channel]) * inlet.scale[channel]
+             + inlet.offset[channel];
+  }
+  return lsl_format_traits<Format>::to_value(frame[channel]);
+}
+
+template <lsl::channel_format_t Format>
+const float* lsl_protocol::decode_frame(
+    inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame)
+{
+  const std::size_t channels = inlet.decoded.size();
+  float* out = inlet.decoded.data();
+  if (inlet.quantized)
+    dequantize_samples(
+        kernel_samples(frame), inlet.scale.data(), inlet.offset.data(), out, channels);
+  else
+    convert_samples(kernel_samples(frame), out, channels);
+  return out;
+}
+
+void lsl_protocol::publish_float_frame(inlet_data& inlet, const float* frame)
+{
+  // One notification for the whole frame; small frames do not allocate
+  const std::size_t channels = inlet.decoded.size();
+  switch (channels)
+  {
+    case 2:
+      inlet.frame_parameter->push_value(ossia::vec2f{frame[0], frame[1]});
+      return;
+    case 3:
+      inlet.frame_parameter->push_value(ossia::vec3f{frame[0], frame[1], frame[2]});
+      return;
+    case 4:
+      inlet.frame_parameter->push_value(
+          ossia::vec4f{frame[0], frame[1], frame[2], frame[3]});
+      return;
+    default:
+      inlet.frame_parameter->push_value(
+          std::vector<ossia::value>(frame, frame + channels));
+      return;
+  }
+}
+
+template <lsl::channel_format_t Format>
+void lsl_protocol::publish_frame_value(
+    inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame)
+{
+  using sample_type = typename lsl_format_traits<Format>::sample_type;
+  if constexpr (std::is_arithmetic_v<sample_type>)
+  {
+    if (inlet.float_samples)
+    {
+      publish_float_frame(inlet, decode_frame<Format>(inlet, frame));
+      return;
+    }
+  }
+
+  const std::size_t channels = inlet.stream_info.channel_count;
+  std::vector<ossia::value> values;
+  values.reserve(channels);
+  for (std::size_t i = 0; i < channels; ++i)
+    values.push_back(channel_value<Format>(inlet, frame, i));
+  inlet.frame_parameter->push_value(std::move(values));
+}
+
+void lsl_protocol::alignment_thread_function()
+{
+  using clock = std::chrono::steady_clock;
+  const double rate
+      = std::clamp(m_alignment.rate, min_alignment_rate, max_alignment_rate);
+  const auto period
+      = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1. / rate));
+
+  std::vector<float> frame;
+  auto next = clock::now();
+  while (m_running)
+  {
+    next += period;
+    std::this_thread::sleep_until(next);
+
+    // Late ticks are dropped rather than caught up
+    const auto now = clock::now();
+    if (now > next + period)
+      next = now;
+
+    if (!m_streaming_enabled)
+      continue;
+
+    try
+    {
+      const double local_time = lsl::local_clock() - m_alignment.delay;
+      align_streams(local_time, frame);
+      if (frame.empty())
+        continue;
+
+      std::vector<ossia::value> values(frame.begin(), frame.end());
+      m_aligned_timestamp_parameter->push_value(
+          timestamp_value(local_time - m_context->clock_epoch()));
+      m_aligned_parameter->push_value(std::move(values));
+    }
+    catch (const std::exception& e)
+    {
+      ossia::logger().error("Error aligning streams: {}", e.what());
+    }
+  }
+}
+
+void lsl_protocol::align_streams(double local_time, std::vector<float>& frame)
+{
+  std::vector<std::shared_ptr<inlet_data>> inlets;
+  inlets.reserve(m_alignment.streams.size());
+  {
+    std::lock_guard<std::mutex> lock(m_inlets_mutex);
+    for (const auto& uid : m_alignment.streams)
+    {
+      auto it = m_active_inlets.find(uid);
+      if (it == m_active_inlets.end())
+        return; // Wait until every aligned stream is subscribed
+      inlets.push_back(it->second);
+    }
+  }
+
+  std::size_t channels = 0;
+  for (const auto& inlet : inlets)
+    channels += inlet->stream_info.channel_count;
+  frame.resize(channels);
+
+  // Streams without data yet keep their previous values in the frame
+  float* out = frame.data();
+  for (const auto& inlet : inlets)
+  {
+    auto& shared = *inlet->shared;
+    const std::size_t n = inlet->stream_info.channel_count;
+    dispatch_channel_format(
+        inlet->stream_info.channel_format, [&]<lsl::channel_format_t F>(lsl_format_constant<F>) {
+          using sample_type = typename lsl_format_traits<F>::sample_type;
+          if constexpr (std::is_arithmetic_v<sample_type>)
           {
-            if(inlet.parameters[i])
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (shared.head == 0)
+              return;
+
+            // Aligned time on the clock of the stream
+            const double t = local_time - shared.correction();
+
+            // The ring must reach back to t, else the oldest frame is held
+            const bool late = t < shared.timestamp(shared.tail());
+            if (late && !inlet->alignment_late)
+              ossia::logger().warn(
+                  "LSL alignment delay goes past the buffered frames of {}",
+                  inlet->stream_info.uid);
+            inlet->alignment_late = late;
+
+            // Last frame at or before t: the frames are in timestamp order
+            std::uint64_t lo = shared.tail();
+            std::uint64_t hi = shared.head;
+            while (hi - lo > 1)
             {
-              inlet.parameters[i]->push_value(sample[i]);
-              inlet.last_samples[i] = sample[i];
+              const std::uint64_t mid = lo + (hi - lo) / 2;
+              if (shared.timestamp(mid) <= t)
+                lo = mid;
+              else
+                hi = mid;
             }
-          }
-          inlet.last_update = std::chrono::steady_clock::now();
-        }
-        break;
-      }
-      case lsl::cf_int16: {
-        std::vector<int16_t> sample(inlet.stream_info.channel_count);
-        if(inlet.inlet->pull_sample(sample, 0.0) != 0.0)
-        {
-          for(size_t i = 0; i < sample.size() && i < inlet.parameters.size(); ++i)
-          {
-            if(inlet.parameters[i])
+
+            const bool irregular = inlet->stream_info.nominal_srate <= 0.;
+            const double t0 = shared.timestamp(lo);
+            if (irregular || lo + 1 == shared.head || t <= t0)
             {
-              inlet.parameters[i]->push_value(static_cast<int>(sample[i]));
-              inlet.last_samples[i] = static_cast<int>(sample[i]);
+              // Markers and the stream edges are held, not interpolated
+              convert_samples(kernel_samples(shared.frame<F>(lo)), out, n);
             }
-          }
-          inlet.last_update = std::chrono::steady_clock::now();
-        }
-        break;
-      }
-      case lsl::cf_string: {
-        std::vector<std::string> sample(inlet.stream_info.channel_count);
-        if(inlet.inlet->pull_sample(sample, 0.0) != 0.0)
-        {
-          for(size_t i = 0; i < sample.size() && i < inlet.parameters.size(); ++i)
-          {
-            if(inlet.parameters[i])
+            else
             {
-              inlet.parameters[i]->push_value(sample[i]);
-              inlet.last_samples[i] = sample[i];
+              const double t1 = shared.timestamp(lo + 1);
+              const float w = t1 > t0 ? static_cast<float>((t - t0) / (t1 - t0)) : 0.f;
+              interpolate_samples(
+                  kernel_samples(shared.frame<F>(lo)), kernel_samples(shared.frame<F>(lo + 1)),
+                  std::clamp(w, 0.f, 1.f), out, n);
             }
+
+            if (inlet->quantized)
+              dequantize_samples(out, inlet->scale.data(), inlet->offset.data(), out, n);
           }
-          inlet.last_update = std::chrono::steady_clock::now();
-        }
-        break;
-      }
-      default:
-        break;
-    }
+        });
+    out += n;
   }
-  catch (const std::exception& e)
+}
+
+void lsl_protocol::create_alignment_nodes()
+{
+  if (!m_device || m_aligned_parameter)
+    return;
+
+  auto& root = m_device->get_root_node();
+  auto aligned_node = root.create_child("_aligned");
+  m_aligned_parameter = aligned_node->create_parameter(ossia::val_type::LIST);
+  m_aligned_parameter->set_access(ossia::access_mode::GET);
+  ossia::net::set_description(*aligned_node, "Channels of the aligned streams, resampled");
+
+  auto timestamp_node = aligned_node->create_child("timestamp");
+  m_aligned_timestamp_parameter = timestamp_node->create_parameter(ossia::val_type::VEC2F);
+  m_aligned_timestamp_parameter->set_access(ossia::access_mode::GET);
+  ossia::net::set_description(
+      *timestamp_node, "Time of the aligned frame on the local clock, as [seconds, remainder]");
+}
+
+void lsl_protocol::stats_thread_function()
+{
+  using clock = std::chrono::steady_clock;
+  auto last = clock::now();
+
+  std::unique_lock<std::mutex> lock(m_stats_mutex);
+  while (m_running)
   {
-    ossia::logger().error("Error processing samples for stream {}: {}", 
-                                   inlet.stream_info.uid, e.what());
+    m_stats_cv.wait_for(lock, stats_interval, [this] { return !m_running; });
+    if (!m_running)
+      break;
+    lock.unlock();
+
+    const auto now = clock::now();
+    const double elapsed = std::chrono::duration<double>(now - last).count();
+    last = now;
+
+    try
+    {
+      // The workers are only held up while the parameters of their inlet are pushed
+      std::vector<std::shared_ptr<inlet_data>> inlets;
+      {
+        std::lock_guard<std::mutex> inlets_lock(m_inlets_mutex);
+        inlets.reserve(m_active_inlets.size());
+        for (const auto& [uid, inlet] : m_active_inlets)
+          inlets.push_back(inlet);
+      }
+      for (auto& inlet : inlets)
+      {
+        std::lock_guard<std::mutex> inlet_lock(inlet->mutex);
+        if (inlet->active)
+          publish_inlet_stats(*inlet, elapsed);
+      }
+
+      // Only the list of outlets is copied under the lock of the outlet thread
+      std::lock_guard<std::mutex> outlet_stats_lock(m_outlet_stats_mutex);
+      std::vector<outlet_data*> outlets;
+      {
+        std::lock_guard<std::mutex> outlets_lock(m_outlets_mutex);
+        outlets.reserve(m_active_outlets.size());
+        for (auto& [uid, outlet] : m_active_outlets)
+          outlets.push_back(outlet.get());
+      }
+      for (auto* outlet : outlets)
+        publish_outlet_stats(*outlet, elapsed);
+    }
+    catch (const std::exception& e)
+    {
+      ossia::logger().error("Error publishing LSL statistics: {}", e.what());
+    }
+
+    lock.lock();
   }
 }
 
-void lsl_protocol::create_node_hierarchy_for_stream(const lsl_stream_data& stream)
+void lsl_protocol::publish_inlet_stats(inlet_data& inlet, double elapsed)
+{
+  auto& telemetry = inlet.telemetry;
+  if (!telemetry.rate || elapsed <= 0.)
+    return;
+
+  const auto frames = inlet.stats.frames.load(std::memory_order_relaxed);
+  telemetry.rate->push_value(
+      static_cast<float>((frames - telemetry.reported_frames) / elapsed));
+  telemetry.reported_frames = frames;
+
+  if (inlet.shared && inlet.shared->inlet)
+    telemetry.available->push_value(
+        static_cast<int>(inlet.shared->inlet->samples_available()));
+  telemetry.latency->push_value(
+      static_cast<float>(inlet.stats.latency.load(std::memory_order_relaxed)));
+  telemetry.dropped->push_value(
+      static_cast<int>(inlet.stats.dropped.load(std::memory_order_relaxed)));
+  telemetry.pull_time->push_value(histogram_value(inlet.stats.pull_time));
+  telemetry.decode_time->push_value(histogram_value(inlet.stats.decode_time));
+}
+
+void lsl_protocol::publish_outlet_stats(outlet_data& outlet, double elapsed)
+{
+  auto& telemetry = outlet.telemetry;
+  if (!telemetry.rate || elapsed <= 0.)
+    return;
+
+  const auto frames = outlet.stats.frames.load(std::memory_order_relaxed);
+  telemetry.rate->push_value(
+      static_cast<float>((frames - telemetry.reported_frames) / elapsed));
+  telemetry.reported_frames = frames;
+
+  if (outlet.outlet)
+    telemetry.consumers->push_value(outlet.outlet->have_consumers());
+  telemetry.push_time->push_value(histogram_value(outlet.stats.push_time));
+}
+
+void lsl_protocol::create_inlet_stats_nodes(inlet_data& inlet)
+{
+  auto stats_node = inlet.sensor->create_child("_stats");
+  auto& telemetry = inlet.telemetry;
+  telemetry.rate = create_stats_parameter(
+      *stats_node, "rate", ossia::val_type::FLOAT, "Frames received per second");
+  auto nominal_rate = create_stats_parameter(
+      *stats_node, "nominal_rate", ossia::val_type::FLOAT,
+      "Sampling rate declared by the stream, 0 for irregular streams");
+  nominal_rate->push_value(static_cast<float>(inlet.stream_info.nominal_srate));
+  telemetry.available = create_stats_parameter(
+      *stats_node, "available", ossia::val_type::INT,
+      "Samples waiting in the liblsl queue of the inlet");
+  telemetry.latency = create_stats_parameter(
+      *stats_node, "latency", ossia::val_type::FLOAT,
+      "Seconds between the capture and the reception of the last frame");
+  telemetry.dropped = create_stats_parameter(
+      *stats_node, "dropped", ossia::val_type::INT,
+      "Frames overwritten in the shared buffer before this device read them");
+  telemetry.pull_time = create_stats_parameter(
+      *stats_node, "pull_time", ossia::val_type::LIST,
+      "Pulls since the last update per duration: under 1 us, then [2^(k-1), 2^k) us");
+  telemetry.decode_time = create_stats_parameter(
+      *stats_node, "decode_time", ossia::val_type::LIST,
+      "Decodings since the last update per duration: under 1 us, then [2^(k-1), 2^k) us");
+}
+
+void lsl_protocol::create_outlet_stats_nodes(
+    outlet_data& outlet, ossia::net::node_base& outlet_node)
+{
+  auto stats_node = outlet_node.create_child("_stats");
+  auto& telemetry = outlet.telemetry;
+  telemetry.rate = create_stats_parameter(
+      *stats_node, "rate", ossia::val_type::FLOAT, "Frames sent per second");
+  telemetry.consumers = create_stats_parameter(
+      *stats_node, "consumers", ossia::val_type::BOOL,
+      "Whether an inlet is connected to the outlet");
+  telemetry.push_time = create_stats_parameter(
+      *stats_node, "push_time", ossia::val_type::LIST,
+      "Pushes since the last update per duration: under 1 us, then [2^(k-1), 2^k) us");
+}
+
+void lsl_protocol::create_node_hierarchy_for_stream(inlet_data& inlet)
 {
   if (!m_device)
     return;
-    
+
+  const auto& stream = inlet.stream_info;
+
   auto& root = m_device->get_root_node();
   
   // Create stream node
@@ -508,15 +1710,80 @@ void lsl_protocol::create_node_hierarchy_for_stream(const lsl_stream_data& strea
   auto stream_node = root.create_child(name);
   ossia::net::set_description(*stream_node, stream.uid);
 
-  // Get the inlet data
-  auto& inlet = m_active_inlets[stream.uid];
   inlet.sensor = stream_node;
+
+  // Timing of the stream, in seconds
+  auto clock_node = stream_node->create_child("_clock");
+  auto timestamp_node = clock_node->create_child("timestamp");
+  inlet.timestamp_parameter = timestamp_node->create_parameter(ossia::val_type::VEC2F);
+  inlet.timestamp_parameter->set_access(ossia::access_mode::GET);
+  ossia::net::set_description(
+      *timestamp_node,
+      "Capture time of the last sample on the local clock, as [seconds, remainder]");
+
+  auto offset_node = clock_node->create_child("offset");
+  inlet.offset_parameter = offset_node->create_parameter(ossia::val_type::FLOAT);
+  inlet.offset_parameter->set_access(ossia::access_mode::GET);
+  inlet.offset_parameter->push_value(static_cast<float>(inlet.last_offset));
+  ossia::net::set_description(*offset_node, "Offset from the stream clock to the local clock");
+
+  create_inlet_stats_nodes(inlet);
+
+  if (stream.nominal_srate <= 0.)
+  {
+    auto event_node = stream_node->create_child("_event");
+    inlet.event_parameter = event_node->create_parameter(ossia::val_type::LIST);
+    inlet.event_parameter->set_access(ossia::access_mode::GET);
+    ossia::net::set_description(
+        *event_node, "Every marker of the stream, as [seconds, remainder, channels...]");
+  }
+
+  if (inlet.options.delivery == lsl_delivery_policy::batch)
+  {
+    auto batch_node = stream_node->create_child("_batch");
+    inlet.batch_parameter = batch_node->create_parameter(ossia::val_type::LIST);
+    inlet.batch_parameter->set_access(ossia::access_mode::GET);
+    ossia::net::set_description(
+        *batch_node, "Frames of the last drain, as [seconds, remainder, channels...]");
+  }
+
+  if (inlet.options.frame_mode)
+  {
+    // The whole frame is carried by the stream node itself
+    auto type = ossia::val_type::LIST;
+    if (stream.channel_format == lsl::cf_float32 || stream.channel_format == lsl::cf_double64
+        || (inlet.quantized && stream.channel_format != lsl::cf_string))
+    {
+      switch (stream.channel_count)
+      {
+        case 2: type = ossia::val_type::VEC2F; break;
+        case 3: type = ossia::val_type::VEC3F; break;
+        case 4: type = ossia::val_type::VEC4F; break;
+        default: break;
+      }
+    }
+
+    inlet.frame_parameter = stream_node->create_parameter(type);
+    inlet.frame_parameter->set_access(ossia::access_mode::GET);
+  }
+  else
+  {
+    create_channel_parameters(inlet);
+  }
+}
+
+void lsl_protocol::create_channel_parameters(inlet_data& inlet)
+{
+  if (!inlet.sensor || !inlet.parameters.empty())
+    return;
+
+  const auto& stream = inlet.stream_info;
   inlet.parameters.reserve(stream.channels.size());
 
   // Create parameter nodes for each channel
   for (const auto& channel : stream.channels)
   {
-    auto param_node = stream_node->create_child(channel.name);
+    auto param_node = inlet.sensor->create_child(channel.name);
     auto param = param_node->create_parameter(channel.ossia_type);
     
     if (!channel.unit.empty())
@@ -1,4 +1,5 @@
 #pragma once
+#include <ossia/detail/lockfree_queue.hpp>
 #include <ossia/detail/logger.hpp>
 #include <ossia/network/base/device.hpp>
 #include <ossia/network/base/node.hpp>
@@ -8,19 +9,28 @@
 #include <ossia/network/domain/domain.hpp>
 #include <ossia/network/value/value.hpp>
 
+#include <LSL/lsl_codec.hpp>
+#include <LSL/lsl_staging.hpp>
+#include <LSL/lsl_stats.hpp>
 #include <LSL/lsl_structs.hpp>
 
 #include <lsl_cpp.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <thread>
 #include <unordered_map>
+#include <variant>
 
 namespace lsl_protocol
 {
 class lsl_context;
+struct lsl_shared_inlet;
 
 
 class lsl_protocol final : public ossia::net::protocol_base
@@ -32,6 +42,8 @@ public:
   bool pull(ossia::net::parameter_base&) override;
   bool push(const ossia::net::parameter_base&, const ossia::value& v) override;
   bool push_raw(const ossia::net::full_parameter_data&) override;
+  bool push_bundle(const std::vector<const ossia::net::parameter_base*>&) override;
+  bool push_raw_bundle(const std::vector<ossia::net::full_parameter_data>&) override;
   bool observe(ossia::net::parameter_base&, bool) override;
   bool update(ossia::net::node_base& node_base) override;
 
@@ -42,24 +54,43 @@ public:
   void stop() override;
 
   // Stream management
-  bool subscribe_to_stream(const std::string& stream_uid);
+  bool subscribe_to_stream(
+      const std::string& stream_uid, const lsl_inlet_options& options = {});
+
+  // Resolves and opens all the streams concurrently, without holding any lock,
+  // then adds each inlet to the active set. Takes as long as the slowest stream.
+  using stream_subscription = std::pair<std::string, lsl_inlet_options>;
+  void subscribe_to_streams(const std::vector<stream_subscription>& streams);
   void unsubscribe_from_stream(const std::string& stream_uid);
   std::vector<lsl_stream_data> get_available_streams() const;
   
   // Outlet management
   std::string create_outlet(
       const lsl::stream_info& info,
-      const std::vector<lsl_channel_info>& channel_info = {});
+      const std::vector<lsl_channel_info>& channel_info = {},
+      const lsl_outlet_options& options = {});
   void destroy_outlet(const std::string& outlet_uid);
+  // Sends a whole sample, staged for the outlet thread like the writes from score
   void push_typed_sample(const std::string& outlet_uid, const std::vector<ossia::value>& values);
 
   // Enable/disable automatic streaming
   void set_streaming_enabled(bool enabled) { m_streaming_enabled = enabled; }
   bool is_streaming_enabled() const { return m_streaming_enabled; }
 
-  // Configuration
-  void set_stream_type_filter(const std::string& filter) { m_stream_type_filter = filter; }
-  const std::string& get_stream_type_filter() const { return m_stream_type_filter; }
+  // Aligned frames of several subscribed streams, published on the _aligned node.
+  // Must be set before start_discovery.
+  void set_alignment(const lsl_alignment_options& options) { m_alignment = options; }
+
+  // Number of inlet worker threads, 0 picks one from the hardware.
+  // Must be set before start_discovery.
+  void set_worker_count(int count) { m_worker_count = count; }
+
+  // Configuration. The filter is applied by liblsl during discovery,
+  // must be set before start_discovery.
+  void set_stream_filter(const lsl_stream_filter& filter) { m_stream_filter = filter; }
+  const lsl_stream_filter& get_stream_filter() const { return m_stream_filter; }
+  void set_stream_type_filter(const std::string& filter) { m_stream_filter.type = filter; }
+  const std::string& get_stream_type_filter() const { return m_stream_filter.type; }
 
 
 private:
@@ -69,20 +100,130 @@ private:
   // Discovery
   std::shared_ptr<lsl_context> m_context;
   
+  // Telemetry parameters under the _stats node of a stream or an outlet, published
+  // by the stats thread. The frame count is the one of the previous publication.
+  struct stats_parameters
+  {
+    ossia::net::parameter_base* rate{};
+    ossia::net::parameter_base* available{};
+    ossia::net::parameter_base* latency{};
+    ossia::net::parameter_base* dropped{};
+    ossia::net::parameter_base* pull_time{};
+    ossia::net::parameter_base* decode_time{};
+    ossia::net::parameter_base* consumers{};
+    ossia::net::parameter_base* push_time{};
+    std::uint64_t reported_frames{};
+  };
+
   // Stream management
   struct inlet_data
   {
-    std::unique_ptr<lsl::stream_inlet> inlet;
+    // Shared with the other devices subscribed to the stream
+    std::shared_ptr<lsl_shared_inlet> shared;
+    std::uint64_t cursor{}; // Next frame of the shared ring to read
+
+    // Frames copied out of the shared ring by the last pull, at most a chunk,
+    // so that they are published without holding its mutex
+    lsl_sample_buffer pending;
+    std::vector<double> pending_timestamps;
     lsl_stream_data stream_info;
+    lsl_inlet_options options;
     ossia::net::node_base* sensor{};
+    ossia::net::parameter_base* frame_parameter{};
     std::vector<ossia::net::parameter_base*> parameters;
+
+    // Marker streams: every event as a [seconds, remainder, channels...] list, in order
+    ossia::net::parameter_base* event_parameter{};
+
+    // Capture time of the last published frame on the local LSL clock, relative to
+    // the context epoch, as [seconds, remainder], and the clock offset of the stream
+    ossia::net::parameter_base* timestamp_parameter{};
+    ossia::net::parameter_base* offset_parameter{};
+    double clock_epoch{};
+    double last_offset{};
+
+    // Batch delivery: every frame as a [seconds, remainder, channels...] list, queued by the
+    // workers without locking and pushed as a single list of frames at the end of
+    // each drain of the inlet, or when the parameter is pulled
+    ossia::net::parameter_base* batch_parameter{};
+    ossia::mpmc_queue<ossia::value> batch;
+    std::mutex batch_mutex; // Serializes the drains, so that batches stay in order
+
     std::vector<ossia::value> last_samples;
     std::chrono::steady_clock::time_point last_update;
+
+    // Quantised streams are mapped back to floats: sample * scale + offset
+    bool quantized{false};
+    std::vector<float> scale;
+    std::vector<float> offset;
+
+    // Float, double and quantised streams: each frame is converted at once into
+    // this array by the kernels, and only boxed when pushed
+    bool float_samples{false};
+    std::vector<float> decoded;
+
+    // Decoder specialised for the channel format of the stream, chosen at subscribe time
+    std::size_t (lsl_protocol::*decode)(inlet_data&){};
+
+    // Current polling period, derived from nominal_srate and backed off while idle
+    std::chrono::steady_clock::duration poll_interval{};
+
+    // Only touched by the alignment thread: whether the aligned time is older than
+    // the buffered frames, to warn once per occurrence
+    bool alignment_late{false};
+
+    // Telemetry, counted by the worker processing the inlet
+    lsl_inlet_stats stats;
+    stats_parameters telemetry;
+
+    // Held by the worker processing the inlet, and while tearing it down
+    std::mutex mutex;
+    std::atomic_bool active{true};
   };
   
-  std::unordered_map<std::string, inlet_data> m_active_inlets;
+  // Protects the map itself; each inlet is owned by one worker at a time
+  std::unordered_map<std::string, std::shared_ptr<inlet_data>> m_active_inlets;
   std::mutex m_inlets_mutex;
+
+  // Batch parameters to their inlet, for pull. Protected by m_inlets_mutex.
+  std::unordered_map<const ossia::net::parameter_base*, std::shared_ptr<inlet_data>>
+      m_batch_index;
+
+  // Inlet worker pool: every worker has a min-heap of the next wakeup of its inlets,
+  // and idle workers steal overdue inlets from the others.
+  struct scheduled_inlet
+  {
+    std::chrono::steady_clock::time_point due;
+    std::shared_ptr<inlet_data> inlet;
+
+    bool operator>(const scheduled_inlet& other) const noexcept { return due > other.due; }
+  };
+  struct inlet_worker
+  {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<scheduled_inlet> schedule;
+    std::thread thread;
+  };
+  std::vector<std::unique_ptr<inlet_worker>> m_workers;
+  std::atomic<std::size_t> m_next_worker{0};
+  int m_worker_count{0};
   
+  // Alignment: a thread resamples the aligned streams straight from their shared rings
+  lsl_alignment_options m_alignment;
+  std::thread m_alignment_thread;
+  ossia::net::parameter_base* m_aligned_parameter{};
+  ossia::net::parameter_base* m_aligned_timestamp_parameter{};
+
+  // Telemetry: a thread publishes the counters of the inlets and outlets periodically
+  std::thread m_stats_thread;
+  std::mutex m_stats_mutex;
+  std::condition_variable m_stats_cv;
+
+  // Held while publishing the telemetry of the outlets, so that the outlet thread
+  // is not blocked meanwhile and no outlet is destroyed. Taken before m_outlets_mutex.
+  std::mutex m_outlet_stats_mutex;
+
   // Active outlets
   struct outlet_data
   {
@@ -90,24 +231,149 @@ private:
     std::vector<ossia::net::parameter_base*> parameters;
     std::vector<lsl_channel_info> channel_info;
     lsl::channel_format_t format;
+
+    // Writes from score and push_typed_sample, staged without locking nor allocating,
+    // and consumed by the outlet thread
+    lsl_staging_ring staging;
+
+    // Everything below is only touched by the outlet thread
     std::vector<ossia::value> current_values; // Store complete measurement
+
+    // Coalescing: the pending sample is sent at flush_due
+    std::chrono::steady_clock::duration coalesce_window{};
+    std::chrono::steady_clock::time_point flush_due;
+    double pending_timestamp{};
+    bool dirty{false};
+
+    // Float, double and quantised outlets keep the current sample unboxed in
+    // current_samples, converted by the kernels when a frame is appended
+    bool float_samples{false};
+    std::vector<float> current_samples;
+
+    // Domains of the channels, enforced on the float samples
+    bool clamp{false};
+    std::vector<float> min;
+    std::vector<float> max;
+
+    // Quantisation of each channel, for quantised outlets
+    std::vector<float> scale;
+    std::vector<float> offset;
+
+    // Encoder specialised for the channel format, chosen at creation time
+    void (lsl_protocol::*append_frame)(outlet_data&, double timestamp){};
+    void (lsl_protocol::*send_chunk)(outlet_data&){};
+
+    // Multiplexed samples batched for push_chunk_multiplexed, with their timestamps
+    lsl_sample_buffer chunk;
+    std::vector<double> chunk_timestamps;
+
+    // Telemetry, counted by the outlet thread
+    lsl_outlet_stats stats;
+    stats_parameters telemetry;
   };
   
-  std::unordered_map<std::string, outlet_data> m_active_outlets;
+  std::unordered_map<std::string, std::unique_ptr<outlet_data>> m_active_outlets;
   std::mutex m_outlets_mutex;
+
+  // Resolves a parameter written by score to its outlet and channel in O(1).
+  // Maintained by create_outlet / destroy_outlet.
+  struct outlet_slot
+  {
+    outlet_data* outlet{};
+    std::size_t channel{};
+  };
+  std::unordered_map<const ossia::net::parameter_base*, outlet_slot> m_outlet_index;
+  std::unordered_map<std::string, outlet_slot> m_outlet_address_index; // For push_raw
+  std::unordered_map<std::string, outlet_data*> m_outlet_uid_index;    // For push_typed_sample
+  std::shared_mutex m_outlet_index_mutex;
+
+  // Sends the staged writes; started with the first outlet.
+  // m_outlet_wakeup_mutex is only used to put the thread to sleep and wake it up.
+  std::thread m_outlet_thread;
+  std::mutex m_outlet_wakeup_mutex;
+  std::condition_variable m_outlets_cv;
+  std::atomic_bool m_outlet_thread_running{false};
+  std::atomic_bool m_outlet_pending{false};
+  std::atomic_bool m_outlet_thread_sleeping{false};
   
-  // Streaming thread
-  std::thread m_streaming_thread;
+  // Streaming state
   std::atomic<bool> m_streaming_enabled{true};
   std::atomic<bool> m_running{false};
   
   // Configuration
-  std::string m_stream_type_filter; // Empty means all types
+  lsl_stream_filter m_stream_filter; // Empty fields match everything
+  std::string m_discovery_predicate; // Acquired from the context while running
+  bool m_discovery_acquired{false};
   
   // Helper methods
-  void streaming_thread_function();
-  void process_inlet_samples(inlet_data& inlet);
-  void create_node_hierarchy_for_stream(const lsl_stream_data& stream);
+  template <typename Writes, typename Resolve>
+  bool stage_writes(const Writes& writes, Resolve&& resolve);
+  template <typename Value>
+  static bool stage_write(
+      outlet_data& outlet, std::size_t channel, double timestamp, Value&& value,
+      bool commit);
+  void wake_outlet_thread();
+  void outlet_thread_function();
+  void process_outlet(outlet_data& outlet, std::chrono::steady_clock::time_point now);
+  template <lsl::channel_format_t Format>
+  void append_outlet_frame(outlet_data& outlet, double timestamp);
+  template <lsl::channel_format_t Format>
+  void append_float_frame(outlet_data& outlet, double timestamp);
+  template <lsl::channel_format_t Format>
+  void append_quantized_frame(outlet_data& outlet, double timestamp);
+  template <lsl::channel_format_t Format>
+  void send_outlet_chunk(outlet_data& outlet);
+  std::shared_ptr<inlet_data>
+  open_inlet(const std::string& stream_uid, const lsl_inlet_options& options);
+  bool activate_inlet(std::shared_ptr<inlet_data> inlet);
+  void worker_thread_function(std::size_t index);
+  std::shared_ptr<inlet_data> steal_inlet(std::size_t thief, std::chrono::steady_clock::time_point now);
+  void schedule_inlet(std::shared_ptr<inlet_data> inlet);
+  std::size_t process_inlet_samples(inlet_data& inlet);
+  template <lsl::channel_format_t Format>
+  std::pair<std::size_t, bool>
+  pull_frames(inlet_data& inlet, std::chrono::steady_clock::duration& pulling);
+  template <lsl::channel_format_t Format, typename OnFrame>
+  std::size_t drain_frames(inlet_data& inlet, OnFrame&& on_frame, bool publish_newest);
+  template <lsl::channel_format_t Format>
+  std::size_t drain_inlet(inlet_data& inlet);
+  template <lsl::channel_format_t Format>
+  std::size_t drain_events(inlet_data& inlet);
+  template <lsl::channel_format_t Format>
+  void publish_event(
+      inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame,
+      double timestamp);
+  std::chrono::steady_clock::duration next_poll_interval(inlet_data& inlet, std::size_t frames) const;
+  template <lsl::channel_format_t Format>
+  void publish_frame(
+      inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame,
+      double timestamp);
+  template <lsl::channel_format_t Format>
+  void queue_batch_frame(
+      inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame,
+      double timestamp);
+  void drain_batch(inlet_data& inlet);
+  template <lsl::channel_format_t Format>
+  static const float*
+  decode_frame(inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame);
+  void publish_float_frame(inlet_data& inlet, const float* frame);
+  template <lsl::channel_format_t Format>
+  static ossia::value channel_value(
+      const inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame,
+      std::size_t channel);
+  template <lsl::channel_format_t Format>
+  void publish_frame_value(
+      inlet_data& inlet, const typename lsl_format_traits<Format>::sample_type* frame);
+  void stats_thread_function();
+  void publish_inlet_stats(inlet_data& inlet, double elapsed);
+  void publish_outlet_stats(outlet_data& outlet, double elapsed);
+  void create_inlet_stats_nodes(inlet_data& inlet);
+  void create_outlet_stats_nodes(outlet_data& outlet, ossia::net::node_base& outlet_node);
+  void alignment_thread_function();
+  void align_streams(double local_time, std::vector<float>& frame);
+  void create_alignment_nodes();
+  void create_node_hierarchy_for_stream(inlet_data& inlet);
+  void create_channel_parameters(inlet_data& inlet);
   void remove_node_hierarchy_for_stream(const std::string& stream_uid);
   
   ossia::val_type lsl_format_to_ossia_type(lsl::channel_format_t fmt) const;
@@ -0,0 +1,96 @@
+#pragma once
+#include <ossia/network/value/value.hpp>
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+
+namespace lsl_protocol
+{
+
+// A write to an outlet channel, staged for the outlet thread. Numeric outlets carry
+// the sample as a float, converted by the writer; the others as an ossia::value.
+struct lsl_staged_write
+{
+  std::size_t channel{};
+  double timestamp{};
+  float number{};
+  ossia::value value;
+  bool commit{true}; // The write completes a sample
+};
+
+// Bounded queue of staged writes, allocated once. Any thread can write (the execution
+// thread, the GUI...) by claiming a slot with a compare-and-swap and filling it in
+// place; the outlet thread is the only reader. The sequence number of each slot tells
+// whether it is free or written, as in Vyukov's bounded queue.
+class lsl_staging_ring
+{
+public:
+  explicit lsl_staging_ring(std::size_t capacity = 1024)
+      : m_slots{std::make_unique<slot[]>(std::bit_ceil(capacity))}
+      , m_mask{std::bit_ceil(capacity) - 1}
+  {
+    for(std::size_t i = 0; i <= m_mask; ++i)
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  // Calls fill(lsl_staged_write&) on a free slot. Returns false when the ring is full.
+  template <typename F>
+  bool push(F&& fill)
+  {
+    std::uint64_t pos = m_tail.load(std::memory_order_relaxed);
+    for(;;)
+    {
+      auto& s = m_slots[pos & m_mask];
+      const auto diff = static_cast<std::int64_t>(
+          s.sequence.load(std::memory_order_acquire) - pos);
+      if(diff == 0)
+      {
+        if(m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          fill(s.write);
+          s.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if(diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Calls f(lsl_staged_write&) on the oldest write, only from the reader thread.
+  // Returns false when there is none.
+  template <typename F>
+  bool pop(F&& f)
+  {
+    auto& s = m_slots[m_head & m_mask];
+    if(s.sequence.load(std::memory_order_acquire) != m_head + 1)
+      return false;
+
+    f(s.write);
+    s.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+    ++m_head;
+    return true;
+  }
+
+private:
+  struct slot
+  {
+    std::atomic<std::uint64_t> sequence{};
+    lsl_staged_write write;
+  };
+
+  std::unique_ptr<slot[]> m_slots;
+  std::uint64_t m_mask{};
+  alignas(64) std::atomic<std::uint64_t> m_tail{}; // Next slot to write
+  alignas(64) std::uint64_t m_head{};              // Next slot to read
+};
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+namespace lsl_protocol
+{
+
+// Telemetry counters of the inlets and outlets. They are written by the thread
+// processing the stream and read by the stats thread of the protocol, without locking.
+
+// Histogram of durations in power-of-two microsecond buckets: bucket 0 counts
+// durations under 1 us, bucket k those in [2^(k-1), 2^k) us, the last one the rest
+struct lsl_duration_histogram
+{
+  static constexpr std::size_t bucket_count = 16;
+  std::array<std::atomic<std::uint64_t>, bucket_count> buckets{};
+
+  void record(std::chrono::steady_clock::duration d) noexcept
+  {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    const std::size_t bucket
+        = us <= 0 ? 0
+                  : std::min<std::size_t>(
+                      std::bit_width(static_cast<std::uint64_t>(us)), bucket_count - 1);
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Counts recorded since the previous call
+  template <typename F>
+  void take(F&& f) noexcept
+  {
+    for(auto& bucket : buckets)
+      f(bucket.exchange(0, std::memory_order_relaxed));
+  }
+};
+
+struct lsl_inlet_stats
+{
+  std::atomic<std::uint64_t> frames{};  // Frames read by the subscriber
+  std::atomic<std::uint64_t> dropped{}; // Frames overwritten in the ring before being read
+  std::atomic<double> latency{};        // Local time minus the capture time of the last frame
+  lsl_duration_histogram pull_time;     // Pulling a chunk from liblsl
+  lsl_duration_histogram decode_time;   // Decoding and publishing the frames of a drain
+};
+
+struct lsl_outlet_stats
+{
+  std::atomic<std::uint64_t> frames{}; // Frames pushed to liblsl
+  lsl_duration_histogram push_time;    // Pushing a chunk to liblsl
+};
+
+}
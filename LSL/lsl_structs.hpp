@@ -4,6 +4,9 @@
 #include <ossia/network/domain/domain.hpp>
 
 #include <lsl_cpp.h>
+
+#include <chrono>
+
 namespace lsl_protocol
 {
 class lsl_context;
@@ -17,6 +20,11 @@ struct lsl_channel_info
   ossia::domain domain;
   std::string unit;
 
+  // Quantised channels carry integers standing for sample * scale + offset
+  bool quantized{false};
+  double scale{1.};
+  double offset{0.};
+
   std::strong_ordering operator<=>(const lsl_channel_info&) const noexcept = default;
 };
 
@@ -43,4 +51,88 @@ struct lsl_stream_data
   std::strong_ordering operator<=>(const lsl_stream_data&) const noexcept = default;
 };
 
+// Restricts discovery to the matching streams. Each field is a comma-separated
+// list of alternatives; a '*' at the start and / or end of an alternative is a wildcard.
+// Empty fields match everything.
+struct lsl_stream_filter
+{
+  std::string type;
+  std::string name;
+  std::string hostname;
+  std::string source_id;
+};
+
+// How the samples drained from an inlet on each wakeup are published
+enum class lsl_delivery_policy
+{
+  latest,     // Only the newest frame of the backlog is pushed to the parameters
+  every_frame, // Every frame of the backlog is pushed, in order
+  batch        // The newest frame is pushed, and every frame of the backlog is
+               // pushed to the _batch parameter as one timestamped list
+};
+
+// Buffering and post-processing of the liblsl inlet of a subscription.
+// Subscriptions share an inlet only if they use the same options.
+struct lsl_buffer_options
+{
+  int32_t max_buflen{360};  // Seconds of data buffered (hundreds of samples for irregular streams)
+  int32_t max_chunklen{0};  // Samples per chunk sent by the outlet, 0 for its default
+  bool recover{true};       // Reconnect to a stream recreated by its source
+  uint32_t postprocessing{lsl::post_none}; // lsl::processing_options_t flags
+
+  // Seconds of frames kept in the shared ring of a regular stream, at least,
+  // e.g. to look back by the alignment delay. 0 keeps the default of about 400 ms.
+  double history{0.};
+
+  // Samples sent one by one, timestamps corrected and smoothed as they arrive
+  static lsl_buffer_options low_latency() noexcept
+  {
+    return {1, 1, true, lsl::post_clocksync | lsl::post_dejitter | lsl::post_monotonize};
+  }
+
+  // A couple of seconds of backlog at most
+  static lsl_buffer_options low_memory() noexcept { return {2, 0, true, lsl::post_none}; }
+
+  bool operator==(const lsl_buffer_options&) const noexcept = default;
+};
+
+// Per-subscription options
+struct lsl_inlet_options
+{
+  lsl_delivery_policy delivery{lsl_delivery_policy::latest};
+
+  // Expose the whole frame as a single list / vecNf parameter on the stream node;
+  // the per-channel parameters are then only created on demand.
+  bool frame_mode{false};
+
+  lsl_buffer_options buffering;
+};
+
+// Per-outlet options
+struct lsl_outlet_options
+{
+  // Channel writes within this window are merged into one complete sample.
+  // Zero sends a sample on every write.
+  std::chrono::microseconds coalesce_window{0};
+
+  // For int8 and int16 outlets: the float values are mapped from the domain of
+  // each channel onto the integer range. The scale and offset are written in the
+  // channel descriptions, so that inlets can map them back.
+  bool quantize{false};
+};
+
+// Resampling of several subscribed streams onto a common clock
+struct lsl_alignment_options
+{
+  // UIDs of the aligned streams, in the order of their channels in the aligned frame
+  std::vector<std::string> streams;
+
+  // Aligned frames per second, zero disables the alignment
+  double rate{0.};
+
+  // How far behind the local clock the frames are aligned, in seconds:
+  // must cover the transmission latency of the slowest stream
+  double delay{0.1};
+};
+
 }